@@ -30,7 +30,7 @@
 #include "BF7615BM44LJTX.h"
 
 /* THE VALUE FOR configSTACK_START MUST BE OBTAINED FROM THE .MEM FILE. */
-#define configSTACK_START			( 0x21 )
+#define configSTACK_START			( 0x23 )
 
 /*-----------------------------------------------------------
  * Application specific definitions.
@@ -45,31 +45,349 @@
  *----------------------------------------------------------*/
 
 #define configUSE_PREEMPTION		1
-#define configUSE_IDLE_HOOK			0
-#define configUSE_TICK_HOOK			0
-#define configCPU_CLOCK_HZ			( ( unsigned long ) 12000000 )
+#define configCPU_CLOCK_HZ			( 12000000UL )
 #define configTICK_RATE_HZ			( ( TickType_t ) 100 )
 #define configMAX_PRIORITIES		( 4 )
-#define configMINIMAL_STACK_SIZE	( ( unsigned short ) 200 - ( unsigned short ) configSTACK_START )
-#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 15 * 256 ) )
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#define configMINIMAL_STACK_SIZE	( ( unsigned short ) 200 - ( unsigned short ) configSTACK_START - ( unsigned short ) configPORT_IDLE_STACK_SIZE )
 #define configMAX_TASK_NAME_LEN		( 8 )
-#define configUSE_TRACE_FACILITY	0
 #define configUSE_16_BIT_TICKS		1
 #define configIDLE_SHOULD_YIELD		1
 
-/* Co-routine definitions. */
-#define configUSE_CO_ROUTINES 		0
-#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+/* Set by the BUILD_FLASH_CO_ROUTINES CMake option to flash the LED from
+crflash.c co-routines in place of the flash.c task.  The co-routines are
+scheduled from the idle hook, and crhook.c exchanges values with them from the
+tick hook to check the interrupt side of the co-routine queue API. */
+#ifndef mainCREATE_FLASH_CO_ROUTINES
+	#define mainCREATE_FLASH_CO_ROUTINES	0
+#endif
+
+/* Set by the BUILD_COMTEST_BENCHMARK CMake option to run the comtest.c
+throughput benchmark in place of the COM test tasks.  The benchmark counts the
+passes of the idle hook to measure the processor time the serial port uses. */
+#ifndef mainCREATE_COMTEST_BENCHMARK
+	#define mainCREATE_COMTEST_BENCHMARK	0
+#endif
+
+/* Set by the BUILD_I2C_BENCHMARK CMake option to have the i2ctest.c master
+task compare the processor time per byte of the timer driven and busy-wait
+I2C master transfers, again by counting the passes of the idle hook. */
+#ifndef mainCREATE_I2C_BENCHMARK
+	#define mainCREATE_I2C_BENCHMARK	0
+#endif
+
+/* Set by the BUILD_QUEUE_COPY_BENCHMARK CMake option to run the qcopytest.c
+queue copy benchmark, built once with configUSE_PORT_QUEUE_COPY at 1 and once
+at 0 to compare the two. */
+#ifndef mainCREATE_QUEUE_COPY_BENCHMARK
+	#define mainCREATE_QUEUE_COPY_BENCHMARK	0
+#endif
+
+#if( mainCREATE_FLASH_CO_ROUTINES == 1 )
+	#define configUSE_CO_ROUTINES		1
+	#define configUSE_IDLE_HOOK			1
+	#define configUSE_TICK_HOOK			1
+#else
+	#define configUSE_CO_ROUTINES		0
+	#define configUSE_TICK_HOOK			0
+
+	#if( ( mainCREATE_COMTEST_BENCHMARK == 1 ) || ( mainCREATE_I2C_BENCHMARK == 1 ) )
+		#define configUSE_IDLE_HOOK		1
+	#else
+		#define configUSE_IDLE_HOOK		0
+	#endif
+#endif
+
+#define configMAX_CO_ROUTINE_PRIORITIES	( 2 )
+
+/* With static allocation the demo tasks, their stacks and their queues are
+placed in XRAM by the linker, and vApplicationGetIdleTaskMemory() in main.c
+(or port.c, see configPORT_IDLE_ON_NATIVE_STACK) supplies the idle task memory.  The heap is then only needed for the objects
+that are still created at run time, so it shrinks to make room for them. */
+#define configSUPPORT_STATIC_ALLOCATION		1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+
+/* Fixed-block pool allocator (MemMang/heap_pool.c).  Pools must be listed in
+ascending block size order and must fit in configTOTAL_HEAP_SIZE, counting one
+header byte per block.  A request is served from the smallest pool its size
+fits, or from the next larger pool if that one is empty. */
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* Task control blocks and queues carry an extra ucStaticallyAllocated
+	byte when both allocation schemes are enabled. */
+	#if( configUSE_CO_ROUTINES == 1 )
+		/* Co-routine control blocks (34 bytes) share pool 0, and the one item
+		co-routine queues (43 bytes) share pool 1. */
+		#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 3 * 256 ) )
+		#define configPOOL_0_BLOCK_COUNT	( 5 )
+		#define configPOOL_1_BLOCK_COUNT	( 4 )
+	#else
+		#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 2 * 256 ) )
+		#define configPOOL_0_BLOCK_COUNT	( 2 )
+		#define configPOOL_1_BLOCK_COUNT	( 1 )
+	#endif
+
+	#define configPOOL_0_BLOCK_SIZE		( 42 )		/* Semaphores and event groups. */
+	#define configPOOL_1_BLOCK_SIZE		( 52 )		/* Task control blocks. */
+	#define configPOOL_2_BLOCK_SIZE		( 100 )		/* Queue control blocks with their storage. */
+	#define configPOOL_2_BLOCK_COUNT	( 1 )
+	#define configPOOL_3_BLOCK_SIZE		configMINIMAL_STACK_SIZE	/* Task stacks. */
+	#define configPOOL_3_BLOCK_COUNT	( 1 )
+#else
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 15 * 256 ) )
+
+	#define configPOOL_0_BLOCK_SIZE		( 40 )		/* Semaphores. */
+	#define configPOOL_0_BLOCK_COUNT	( 4 )
+	#define configPOOL_1_BLOCK_SIZE		( 48 )		/* Task control blocks. */
+	#define configPOOL_1_BLOCK_COUNT	( 14 )
+	#define configPOOL_2_BLOCK_SIZE		( 100 )		/* Queue control blocks with their storage. */
+	#define configPOOL_2_BLOCK_COUNT	( 6 )
+	#define configPOOL_3_BLOCK_SIZE		configMINIMAL_STACK_SIZE	/* Task stacks. */
+	#define configPOOL_3_BLOCK_COUNT	( 14 )
+#endif
+
+/* Optional allocation ledger in MemMang/heap_pool.c.  Each live block is
+recorded with its object type, size and owner tag, at a cost of 8 bytes of XRAM
+per entry, and vPortHeapLedgerReport() prints the XRAM budget. */
+#define configUSE_HEAP_LEDGER		0
+#define configHEAP_LEDGER_LENGTH	( 40 )
+
+#if( configUSE_HEAP_LEDGER == 1 )
+	/* Stacks are allocated through pvPortMallocStack() so they can be told
+	apart from TCBs, and the trace hooks below tag the remaining blocks once the
+	kernel has initialised them. */
+	#define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP	1
+
+	void vPortHeapLedgerTagTask( void *pvTCB );
+	void vPortHeapLedgerTagQueue( void *pvQueue, unsigned char ucQueueType );
+
+	#define traceTASK_CREATE( pxNewTCB )		vPortHeapLedgerTagTask( ( void * ) ( pxNewTCB ) )
+
+	/* ucQueueType is the parameter of prvInitialiseNewQueue(), the function in
+	which traceQUEUE_CREATE() is expanded, see below. */
+	#define configHEAP_LEDGER_TAG_QUEUE( pxNewQueue )	vPortHeapLedgerTagQueue( ( void * ) ( pxNewQueue ), ucQueueType )
+#else
+	#define configHEAP_LEDGER_TAG_QUEUE( pxNewQueue )
+#endif
+
+/* Set by the BUILD_STATIC_ALLOCATION_TEST CMake option to run the standard
+StaticAllocation.c demo in place of the I2C demo.  That demo also exercises
+mutexes, counting semaphores, event groups and software timers, so they are
+only enabled, and timers.c and event_groups.c only built, in that case. */
+#ifndef mainCREATE_STATIC_ALLOCATION_TEST
+	#define mainCREATE_STATIC_ALLOCATION_TEST	0
+#endif
+
+#if( mainCREATE_STATIC_ALLOCATION_TEST == 1 )
+	#define configUSE_MUTEXES				1
+	#define configUSE_RECURSIVE_MUTEXES		1
+	#define configUSE_COUNTING_SEMAPHORES	1
+	#define configUSE_TIMERS				1
+	#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+	#define configTIMER_QUEUE_LENGTH		( 2 )
+	#define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
+#else
+	#define configUSE_TIMERS				0
+#endif
+
+/* Memory spaces used for the port and driver variables, see portmacro.h.
+Setting either to xdata trades speed for IRAM or the pdata page.  Moving
+variables into data changes configSTACK_START, which must then be read again
+from the .mem file. */
+#define configPORT_HOT_DATA			data
+#define configPORT_WARM_DATA		pdata
+
+/* Reach TCBs and stacks through two byte xdata pointers inside the port
+instead of three byte generic pointers, see portmacro.h. */
+#define configPORT_USE_XDATA_POINTERS	1
+
+/* Copy queue items through xdata pointers, and 1, 2 and 4 byte items with a
+single access, rather than the library memcpy() loop, see portmacro.h. */
+#ifndef configUSE_PORT_QUEUE_COPY
+	#define configUSE_PORT_QUEUE_COPY	1
+#endif
+
+/* The trace facility adds uxQueueNumber to every queue, where the port's
+queue copy keeps the queue's copy routine.  Nothing else in the demo uses
+it. */
+#define configUSE_TRACE_FACILITY	configUSE_PORT_QUEUE_COPY
+
+/* traceQUEUE_CREATE() runs once for every queue, after its item size is set.
+It records the queue's copy routine in uxQueueNumber (see portmacro.h) and
+tags the queue in the heap ledger. */
+#if( configUSE_PORT_QUEUE_COPY == 1 )
+	#define traceQUEUE_CREATE( pxNewQueue )	{ ( pxNewQueue )->uxQueueNumber = uxPortQueueCopySelect( ( pxNewQueue )->uxItemSize ); configHEAP_LEDGER_TAG_QUEUE( pxNewQueue ); }
+#elif( configUSE_HEAP_LEDGER == 1 )
+	#define traceQUEUE_CREATE( pxNewQueue )	configHEAP_LEDGER_TAG_QUEUE( pxNewQueue )
+#endif
+
+/* Time-triggered cyclic executive, see port_cyclic.h.  The slots listed in
+xPortCyclicSchedule[] in main.c run from the tick interrupt on fixed ticks of
+a configPORT_CYCLIC_MAJOR_TICKS tick major cycle.  Uses timer 0. */
+#define configUSE_PORT_CYCLIC_EXECUTIVE	1
+#define configPORT_CYCLIC_MAJOR_TICKS	( 10 )
+#define configPORT_CYCLIC_SLOTS			( 2 )
+
+/* Serial driver Rx/Tx rings in XRAM (powers of two, at most 128 bytes) and
+the number of buffered characters that wakes a task blocked in uxSerialRead(). */
+#define configSERIAL_RX_BUFFER_SIZE		( 32 )
+#define configSERIAL_TX_BUFFER_SIZE		( 32 )
+#define configSERIAL_RX_TRIGGER_LEVEL	( 1 )
+
+/* Clock of the UART baud rate generators, which divide it by 16 times a 10
+bit divisor.  The UARTs run at twice configCPU_CLOCK_HZ: the serial driver has
+always worked out its divisors for a 24 MHz UART clock with the 12 MHz CPU
+clock prvSetupSystemClock() sets up, so the two follow each other if the CPU
+clock is changed.  It is a constant expression without casts so that the
+divisors, and the error of each rate, can be worked out at compile time.
+Rates further than configSERIAL_MAX_BAUD_ERROR_PERMILLE tenths of a percent
+from the one asked for are refused. */
+#define configSERIAL_CLOCK_HZ			( configCPU_CLOCK_HZ * 2UL )
+#define configSERIAL_MAX_BAUD_ERROR_PERMILLE	( 20 )
+
+/* Deferred binary log (binlog.h), streamed out of UART1 by a task started in
+main.c, through a ring of configBINLOG_BUFFER_SIZE bytes (a power of two, at
+most 128).  Set by the BUILD_BINARY_LOG CMake option, which also generates
+binlog_ids.h from the sources. */
+#ifndef configUSE_BINARY_LOG
+	#define configUSE_BINARY_LOG		0
+#endif
+#define configBINLOG_BUFFER_SIZE		( 64 )
+
+/* Active object dispatcher (active_object.c), which also enables the serial
+and I2C slave hooks that post received bytes to an active object.  Set by the
+BUILD_ACTIVE_OBJECTS CMake option, in which case main.c runs the aotest.c
+benchmark in place of the I2C demo. */
+#ifndef configUSE_ACTIVE_OBJECTS
+	#define configUSE_ACTIVE_OBJECTS	0
+#endif
+
+/* Serve UART1 as well as UART0 in the serial driver.  UART1's pins must then
+be routed by defining configSERIAL_UART1_PIN_SETUP().  Always served when the
+binary log is built, as the log uses it, when the heap ledger is built, as
+main.c sends the ledger report out of it, and when the active objects are
+built, as the aotest.c benchmark takes the characters it receives. */
+#if( ( configUSE_BINARY_LOG == 1 ) || ( configUSE_HEAP_LEDGER == 1 ) || ( configUSE_ACTIVE_OBJECTS == 1 ) )
+	#define configSERIAL_USE_UART1		1
+#else
+	#define configSERIAL_USE_UART1		0
+#endif
+
+/* Serial driver counters (vSerialGetStats()) and GPIO RTS/CTS flow control.
+To use flow control define configSERIAL_SET_RTS( ucUART, xStop ) and
+configSERIAL_CTS_READY( ucUART ) for the pins wired to the other end, for
+example ( PC6 = ( xStop ) ) and ( PC7 == 0 ), and call vSerialFlowControlPoll()
+from the tick hook. */
+#define configSERIAL_USE_STATS			1
+#define configSERIAL_USE_FLOW_CONTROL	0
+
+/* Frame receive mode in the serial driver, in which timer 1 times the gap in
+the line that ends a frame (see serial.h).  Not used by the demo. */
+#define configSERIAL_USE_FRAME_MODE		0
+#define configSERIAL_FRAME_SIZE			( 64 )
+
+/* Double buffered receive into application buffers in the serial driver,
+which also uses timer 1 (see serial.h).  Not used by the demo. */
+#define configSERIAL_USE_RX_BUFFERS		0
+
+/* COBS framed binary RPC server (rpc.h) on UART0, run by main.c in place of
+the COM test tasks for Tools/rpc_client.py.  Set by the BUILD_RPC CMake
+option.  configRPC_FRAME_SIZE bounds a decoded frame, and so the payload of a
+request or response to configRPC_FRAME_SIZE - 4 bytes. */
+#ifndef configUSE_RPC
+	#define configUSE_RPC				0
+#endif
+#define configRPC_FRAME_SIZE			( 64 )
+
+/* Clock the I2C master (i2c_master.c) from the timer 1 interrupt, one SCL
+edge or start/stop step per interrupt configI2C_MASTER_PHASE_US apart, so the
+calling task blocks instead of spinning for the whole transfer.  SCL runs at
+half the interrupt rate; 15 us phases give about the 33 kHz of the busy-wait
+code.  Timer 1 is also used by the serial frame mode and Rx buffers above, so
+those must stay off.
+
+Off by default.  Timer 1 counts machine cycles, configCPU_CLOCK_HZ / 12, so a
+15 us phase is only 15 machine cycles at 12 MHz, fewer than the interrupt's
+own entry, register pushes and pops, critical section and exit take.  The
+timer driven transfers are then likely to cost more processor time than the
+busy-wait ones.  The BUILD_I2C_BENCHMARK option turns them on to measure the
+processor time per byte of both in xI2CBenchResults[]; leave this at 0 until
+those figures show the timer winning at the phase chosen. */
+#if( mainCREATE_I2C_BENCHMARK == 1 )
+	#define configI2C_MASTER_USE_TIMER	1
+#else
+	#define configI2C_MASTER_USE_TIMER	0
+#endif
+#define configI2C_MASTER_PHASE_US		( 15 )
+
+/* Keep the idle task's stack at the base of IRAM for good so switching to or
+from it only copies the other task's stack, see portmacro.h.  The IRAM left to
+the other tasks, and so configMINIMAL_STACK_SIZE, shrinks by
+configPORT_IDLE_STACK_SIZE.
+
+The area must hold the deepest idle context that portSWITCH_OUT() can save,
+which is an interrupt that yields taken at the deepest point of the idle task:
+
+	  idle task frames at that point (prvIdleTask() and the idle hook)	I
+	+ interrupt return address						2
+	+ interrupt prologue, ACC B DPL DPH R0-R7 PSW BP			14
+	+ interrupt locals							4
+	+ portENTER_CRITICAL() in the interrupt, ACC and IE			2
+	+ call to vPortYield() from portYIELD()					2
+	+ portSAVE_CONTEXT()							15
+	+ call to vTaskSwitchContext() and its frame				6
+
+The 2, 2, 2 and 15 are fixed by the port.  The prologue is what SDCC generates
+for an interrupt that calls a function, and the interrupt locals and the
+vTaskSwitchContext() frame are estimates; all three, and I, must be confirmed
+from the .rst listings of a build.  vTaskSwitchContext() runs above the saved
+stack pointer and is counted only as margin.  The tick interrupt needs less,
+2 + 15 with nothing in between.  That is 45 bytes plus I.  Without an idle
+hook, or with only the benchmark idle hooks, I is estimated at no more than
+11 bytes, so 0x38.
+
+port.c halts with the stack pointer in ucPortIdleOverrunSP if the idle context
+ever reaches the task stacks, whether or not configASSERT() is defined, and the
+check task latches an error once uxPortGetIdleStackHighWaterMark() finds the
+whole area used.  uxIdleStackUnused in main.c gives the measured margin.
+
+Not used with co-routines.  The idle hook then runs vCoRoutineSchedule() on
+the idle stack, whose deepest chains, such as crQUEUE_SEND() into
+xQueueCRSend(), vCoRoutineAddToDelayedList() and vListInsert(), or
+prvCheckDelayedList() under vCoRoutineSchedule(), have not been read from
+the .rst listings.  An area too small for them would stop the demo in the
+overrun check above, so the idle task keeps an ordinary copied stack until
+uxIdleStackUnused has been measured on hardware with co-routines running. */
+#if( configUSE_CO_ROUTINES == 1 )
+	#define configPORT_IDLE_ON_NATIVE_STACK	0
+#else
+	#define configPORT_IDLE_ON_NATIVE_STACK	1
+#endif
+
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+	#define configPORT_IDLE_STACK_SIZE	( 0x38 )
+#else
+	#define configPORT_IDLE_STACK_SIZE	( 0 )
+#endif
 
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 
 #define INCLUDE_vTaskPrioritySet		0
-#define INCLUDE_uxTaskPriorityGet		0
-#define INCLUDE_vTaskDelete				0
+#define INCLUDE_vTaskDelete				1
 #define INCLUDE_vTaskCleanUpResources	0
-#define INCLUDE_vTaskSuspend			0
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
 
+/* StaticAllocation.c creates its tasks one priority above its own, suspends
+them and checks their state. */
+#if( mainCREATE_STATIC_ALLOCATION_TEST == 1 )
+	#define INCLUDE_uxTaskPriorityGet	1
+	#define INCLUDE_vTaskSuspend		1
+	#define INCLUDE_eTaskGetState		1
+#else
+	#define INCLUDE_uxTaskPriorityGet	0
+	#define INCLUDE_vTaskSuspend		0
+	#define INCLUDE_eTaskGetState		0
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,693 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+ * Fixed-block pool implementation of pvPortMalloc() and vPortFree() for the
+ * Byd port.
+ *
+ * The configTOTAL_HEAP_SIZE XRAM array is split into portNUM_POOLS pools of
+ * equally sized blocks.  The pools are listed in ascending block size order in
+ * FreeRTOSConfig.h, and are intended to hold (smallest first) semaphores,
+ * TCBs, queues with their storage area, and task stacks.  A request is served
+ * from the smallest pool whose blocks are large enough, falling back to the
+ * next larger pool if that pool is empty.  Allocating is a pop from a singly
+ * linked free list and freeing is a push, so both take a bounded number of
+ * steps no matter how fragmented the pools become.
+ *
+ * Every block is preceded by one header byte that holds the number of bytes
+ * requested for the block, which lets the pools report their internal
+ * fragmentation.  A free block stores the link to the next free block in its
+ * first two payload bytes.  All pointer arithmetic is done with 2 byte xdata
+ * pointers rather than 3 byte generic pointers.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "heap_pool.h"
+#include "port_mem.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* Size of the header that precedes each block, and the header value that marks
+a block as being on a free list. */
+#define heapBLOCK_HEADER_SIZE                           ( 1 )
+#define heapBLOCK_FREE                                  ( ( uint8_t ) 0 )
+
+/* Number of XRAM bytes occupied by a pool, headers included. */
+#define heapPOOL_BYTES( xBlockSize, xBlockCount )       ( ( ( uint16_t ) ( xBlockSize ) + heapBLOCK_HEADER_SIZE ) * ( uint16_t ) ( xBlockCount ) )
+
+/* Offset of each pool within ucHeap[]. */
+#define heapPOOL_0_OFFSET                               ( ( uint16_t ) 0 )
+#define heapPOOL_1_OFFSET                               ( heapPOOL_0_OFFSET + heapPOOL_BYTES( configPOOL_0_BLOCK_SIZE, configPOOL_0_BLOCK_COUNT ) )
+#define heapPOOL_2_OFFSET                               ( heapPOOL_1_OFFSET + heapPOOL_BYTES( configPOOL_1_BLOCK_SIZE, configPOOL_1_BLOCK_COUNT ) )
+#define heapPOOL_3_OFFSET                               ( heapPOOL_2_OFFSET + heapPOOL_BYTES( configPOOL_2_BLOCK_SIZE, configPOOL_2_BLOCK_COUNT ) )
+#define heapPOOL_END_OFFSET                             ( heapPOOL_3_OFFSET + heapPOOL_BYTES( configPOOL_3_BLOCK_SIZE, configPOOL_3_BLOCK_COUNT ) )
+
+/* Compile time checks on the pool configuration.  Block sizes must be listed
+in ascending order, must be able to hold a free list link, and must fit the
+single byte header. */
+typedef char heapPOOLS_MUST_FIT_IN_THE_HEAP[ ( heapPOOL_END_OFFSET <= configTOTAL_HEAP_SIZE ) ? 1 : -1 ];
+typedef char heapPOOLS_MUST_BE_IN_ASCENDING_ORDER[ ( ( configPOOL_0_BLOCK_SIZE <= configPOOL_1_BLOCK_SIZE ) &&
+                                                     ( configPOOL_1_BLOCK_SIZE <= configPOOL_2_BLOCK_SIZE ) &&
+                                                     ( configPOOL_2_BLOCK_SIZE <= configPOOL_3_BLOCK_SIZE ) ) ? 1 : -1 ];
+typedef char heapBLOCKS_MUST_HOLD_A_LINK[ ( configPOOL_0_BLOCK_SIZE >= 2 ) ? 1 : -1 ];
+typedef char heapBLOCKS_MUST_FIT_THE_HEADER[ ( configPOOL_3_BLOCK_SIZE <= 0xff ) ? 1 : -1 ];
+
+/* A pointer to a block header.  Always an xdata pointer. */
+typedef xdata uint8_t *BlockPointer_t;
+
+/* Read only description of a pool, held in code memory. */
+typedef struct xPOOL_DESCRIPTOR
+{
+    uint8_t ucBlockSize;
+    uint8_t ucBlockCount;
+    uint16_t usStartOffset;
+    uint16_t usEndOffset;
+} PoolDescriptor_t;
+
+/* Run time state of a pool. */
+typedef struct xPOOL_STATE
+{
+    BlockPointer_t pucFreeList;
+    uint8_t ucBlocksFree;
+    uint8_t ucMinimumBlocksFree;
+    uint8_t ucFailedRequests;
+    uint8_t ucOverflowAllocations;
+    uint16_t usBytesRequested;
+} PoolState_t;
+
+static code const PoolDescriptor_t xPoolDescriptors[ portNUM_POOLS ] =
+{
+    { configPOOL_0_BLOCK_SIZE, configPOOL_0_BLOCK_COUNT, heapPOOL_0_OFFSET, heapPOOL_1_OFFSET },
+    { configPOOL_1_BLOCK_SIZE, configPOOL_1_BLOCK_COUNT, heapPOOL_1_OFFSET, heapPOOL_2_OFFSET },
+    { configPOOL_2_BLOCK_SIZE, configPOOL_2_BLOCK_COUNT, heapPOOL_2_OFFSET, heapPOOL_3_OFFSET },
+    { configPOOL_3_BLOCK_SIZE, configPOOL_3_BLOCK_COUNT, heapPOOL_3_OFFSET, heapPOOL_END_OFFSET }
+};
+
+/* The pools themselves, and their free lists. */
+static xdata uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+static portWARM_DATA PoolState_t xPoolState[ portNUM_POOLS ];
+
+/* Set to pdFALSE to have the pools rebuilt by the next call to pvPortMalloc(). */
+static portWARM_DATA BaseType_t xHeapInitialised = pdFALSE;
+
+#if( configUSE_HEAP_LEDGER == 1 )
+
+    /* One ledger entry per live block.  The table is not static so it can be
+    located from the linker map and dumped from a ucsim session with
+    "dump xram <address of _xHeapLedger> <size>". */
+    typedef struct xHEAP_LEDGER_ENTRY
+    {
+        BlockPointer_t pucBlock;            /* NULL when the entry is unused. */
+        uint8_t ucSize;                     /* Bytes requested. */
+        uint8_t ucType;                     /* One of the portHEAP_OBJECT_ constants. */
+        char cOwner[ portHEAP_LEDGER_OWNER_LEN ];
+    } HeapLedgerEntry_t;
+
+    portCOLD_DATA HeapLedgerEntry_t xHeapLedger[ configHEAP_LEDGER_LENGTH ];
+
+    /* Allocations that could not be recorded because the ledger was full. */
+    static uint8_t ucLedgerOverflows = 0;
+
+    /* Owner tag applied to queues and semaphores as they are allocated. */
+    static char cCurrentOwner[ portHEAP_LEDGER_OWNER_LEN ] = { '-', 0, 0, 0 };
+
+    /* The most recently allocated stack.  The kernel allocates the TCB and then
+    the stack, and only then calls traceTASK_CREATE(), which names both. */
+    static xdata HeapLedgerEntry_t *pxLastStackEntry = NULL;
+
+    static code const char cObjectNames[][ 4 ] = { "?  ", "TCB", "STK", "QUE", "SEM" };
+
+    static void prvLedgerAdd(BlockPointer_t pucBlock, uint8_t ucSize, uint8_t ucType);
+    static void prvLedgerRemove(BlockPointer_t pucBlock);
+    static xdata HeapLedgerEntry_t *prvLedgerFind(BlockPointer_t pucBlock);
+    static void prvPutString(void (*vPutChar)(char cChar), code const char *pcString, uint8_t ucMaxLength);
+    static void prvPutDecimal(void (*vPutChar)(char cChar), uint16_t usValue);
+
+#else
+
+    #define prvLedgerAdd( pucBlock, ucSize, ucType )
+    #define prvLedgerRemove( pucBlock )
+
+#endif /* configUSE_HEAP_LEDGER */
+
+/*
+ * Thread every block of every pool onto its pool's free list.
+ */
+static void prvHeapInit(void);
+
+/*
+ * Take a block of at least xWantedSize bytes from the pools, recording it in
+ * the ledger (if used) as an object of type ucType.
+ */
+static void *prvAllocate(size_t xWantedSize, uint8_t ucType);
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return prvAllocate(xWantedSize, portHEAP_OBJECT_UNKNOWN);
+}
+/*-----------------------------------------------------------*/
+
+#if( configSTACK_ALLOCATION_FROM_SEPARATE_HEAP == 1 )
+
+    void *pvPortMallocStack(size_t xWantedSize)
+    {
+        return prvAllocate(xWantedSize, portHEAP_OBJECT_STACK);
+    }
+    /*-----------------------------------------------------------*/
+
+    void vPortFreeStack(void *pv)
+    {
+        vPortFree(pv);
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* configSTACK_ALLOCATION_FROM_SEPARATE_HEAP */
+
+static void *prvAllocate(size_t xWantedSize, uint8_t ucType)
+{
+    void *pvReturn = NULL;
+    BlockPointer_t pucBlock;
+    portWARM_DATA PoolState_t *pxState;
+    uint8_t ucPool, ucBestFit;
+
+    vTaskSuspendAll();
+    {
+        if(xHeapInitialised == pdFALSE)
+        {
+            prvHeapInit();
+        }
+
+        if((xWantedSize > 0) && (xWantedSize <= configPOOL_3_BLOCK_SIZE))
+        {
+            /* Find the smallest pool with blocks large enough.  The size check
+            above means there always is one. */
+            ucBestFit = 0;
+            while(xWantedSize > xPoolDescriptors[ ucBestFit ].ucBlockSize)
+            {
+                ucBestFit++;
+            }
+
+            /* Take the first free block from that pool, or from the next larger
+            pool that still has one. */
+            for(ucPool = ucBestFit; ucPool < portNUM_POOLS; ucPool++)
+            {
+                pxState = &xPoolState[ ucPool ];
+                pucBlock = pxState->pucFreeList;
+
+                if(pucBlock != NULL)
+                {
+                    pxState->pucFreeList = *((BlockPointer_t xdata *)(pucBlock + heapBLOCK_HEADER_SIZE));
+                    pucBlock[ 0 ] = (uint8_t) xWantedSize;
+
+                    pxState->ucBlocksFree--;
+                    if(pxState->ucBlocksFree < pxState->ucMinimumBlocksFree)
+                    {
+                        pxState->ucMinimumBlocksFree = pxState->ucBlocksFree;
+                    }
+                    pxState->usBytesRequested += (uint16_t) xWantedSize;
+
+                    if((ucPool != ucBestFit) && (pxState->ucOverflowAllocations != 0xff))
+                    {
+                        pxState->ucOverflowAllocations++;
+                    }
+
+                    prvLedgerAdd(pucBlock, (uint8_t) xWantedSize, ucType);
+
+                    pvReturn = (void *)(pucBlock + heapBLOCK_HEADER_SIZE);
+                    break;
+                }
+            }
+
+            if((pvReturn == NULL) && (xPoolState[ ucBestFit ].ucFailedRequests != 0xff))
+            {
+                xPoolState[ ucBestFit ].ucFailedRequests++;
+            }
+        }
+
+        traceMALLOC(pvReturn, xWantedSize);
+    }
+    (void) xTaskResumeAll();
+
+#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if(pvReturn == NULL)
+        {
+            extern void vApplicationMallocFailedHook(void);
+            vApplicationMallocFailedHook();
+        }
+    }
+#endif
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree(void *pv)
+{
+    BlockPointer_t pucBlock;
+    portWARM_DATA PoolState_t *pxState;
+    uint8_t ucPool;
+
+    if(pv == NULL)
+    {
+        return;
+    }
+
+    pucBlock = ((BlockPointer_t) pv) - heapBLOCK_HEADER_SIZE;
+
+    vTaskSuspendAll();
+    {
+        /* The pools occupy consecutive ranges of ucHeap[], so the owning pool
+        is found with at most portNUM_POOLS address compares. */
+        for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+        {
+            if(pucBlock < &ucHeap[ xPoolDescriptors[ ucPool ].usEndOffset ])
+            {
+                break;
+            }
+        }
+
+        configASSERT(pucBlock >= &ucHeap[ 0 ]);
+        configASSERT(ucPool < portNUM_POOLS);
+
+        /* Catch a double free. */
+        configASSERT(pucBlock[ 0 ] != heapBLOCK_FREE);
+
+        if((ucPool < portNUM_POOLS) && (pucBlock[ 0 ] != heapBLOCK_FREE))
+        {
+            prvLedgerRemove(pucBlock);
+
+            pxState = &xPoolState[ ucPool ];
+            pxState->usBytesRequested -= pucBlock[ 0 ];
+            pucBlock[ 0 ] = heapBLOCK_FREE;
+
+            *((BlockPointer_t xdata *)(pucBlock + heapBLOCK_HEADER_SIZE)) = pxState->pucFreeList;
+            pxState->pucFreeList = pucBlock;
+            pxState->ucBlocksFree++;
+
+            traceFREE(pv, xPoolDescriptors[ ucPool ].ucBlockSize);
+        }
+    }
+    (void) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks(void)
+{
+    /* Only required when static memory is not cleared. */
+    xHeapInitialised = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize(void)
+{
+    size_t xFreeBytes = 0;
+    uint8_t ucPool;
+
+    for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+    {
+        xFreeBytes += (size_t) xPoolState[ ucPool ].ucBlocksFree * xPoolDescriptors[ ucPool ].ucBlockSize;
+    }
+
+    return xFreeBytes;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    size_t xFreeBytes = 0;
+    uint8_t ucPool;
+
+    for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+    {
+        xFreeBytes += (size_t) xPoolState[ ucPool ].ucMinimumBlocksFree * xPoolDescriptors[ ucPool ].ucBlockSize;
+    }
+
+    return xFreeBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetPoolStats(UBaseType_t uxPool, PoolStats_t *pxStats)
+{
+    portWARM_DATA PoolState_t *pxState;
+    uint8_t ucBlocksInUse;
+
+    configASSERT(uxPool < portNUM_POOLS);
+
+    pxState = &xPoolState[ uxPool ];
+
+    vTaskSuspendAll();
+    {
+        if(xHeapInitialised == pdFALSE)
+        {
+            prvHeapInit();
+        }
+
+        ucBlocksInUse = xPoolDescriptors[ uxPool ].ucBlockCount - pxState->ucBlocksFree;
+
+        pxStats->ucBlockSize = xPoolDescriptors[ uxPool ].ucBlockSize;
+        pxStats->ucBlockCount = xPoolDescriptors[ uxPool ].ucBlockCount;
+        pxStats->ucBlocksFree = pxState->ucBlocksFree;
+        pxStats->ucMinimumBlocksFree = pxState->ucMinimumBlocksFree;
+        pxStats->ucFailedRequests = pxState->ucFailedRequests;
+        pxStats->ucOverflowAllocations = pxState->ucOverflowAllocations;
+        pxStats->usBytesRequested = pxState->usBytesRequested;
+        pxStats->usBytesWasted = ((uint16_t) ucBlocksInUse * pxStats->ucBlockSize) - pxState->usBytesRequested;
+    }
+    (void) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit(void)
+{
+    BlockPointer_t pucBlock;
+    portWARM_DATA PoolState_t *pxState;
+    uint8_t ucPool, ucBlock;
+
+    for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+    {
+        pxState = &xPoolState[ ucPool ];
+        pxState->pucFreeList = NULL;
+        pucBlock = &ucHeap[ xPoolDescriptors[ ucPool ].usStartOffset ];
+
+        for(ucBlock = 0; ucBlock < xPoolDescriptors[ ucPool ].ucBlockCount; ucBlock++)
+        {
+            pucBlock[ 0 ] = heapBLOCK_FREE;
+            *((BlockPointer_t xdata *)(pucBlock + heapBLOCK_HEADER_SIZE)) = pxState->pucFreeList;
+            pxState->pucFreeList = pucBlock;
+            pucBlock += xPoolDescriptors[ ucPool ].ucBlockSize + heapBLOCK_HEADER_SIZE;
+        }
+
+        pxState->ucBlocksFree = xPoolDescriptors[ ucPool ].ucBlockCount;
+        pxState->ucMinimumBlocksFree = pxState->ucBlocksFree;
+        pxState->ucFailedRequests = 0;
+        pxState->ucOverflowAllocations = 0;
+        pxState->usBytesRequested = 0;
+    }
+
+    xHeapInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_HEAP_LEDGER == 1 )
+
+    void vPortHeapLedgerSetOwner(const char *pcOwner)
+    {
+        uint8_t ucChar;
+
+        vTaskSuspendAll();
+        {
+            for(ucChar = 0; ucChar < portHEAP_LEDGER_OWNER_LEN; ucChar++)
+            {
+                cCurrentOwner[ ucChar ] = *pcOwner;
+                if(*pcOwner != 0)
+                {
+                    pcOwner++;
+                }
+            }
+        }
+        (void) xTaskResumeAll();
+    }
+    /*-----------------------------------------------------------*/
+
+    void vPortHeapLedgerTagTask(void *pvTCB)
+    {
+        xdata HeapLedgerEntry_t *pxEntry;
+        const char *pcName;
+        uint8_t ucChar;
+
+        /* Called from within the kernel, so the scheduler is either not
+        running or already locked out. */
+        pcName = pcTaskGetName((TaskHandle_t) pvTCB);
+        pxEntry = prvLedgerFind(((BlockPointer_t) pvTCB) - heapBLOCK_HEADER_SIZE);
+
+        if(pxEntry != NULL)
+        {
+            pxEntry->ucType = portHEAP_OBJECT_TCB;
+        }
+
+        for(ucChar = 0; ucChar < portHEAP_LEDGER_OWNER_LEN; ucChar++)
+        {
+            if(pxEntry != NULL)
+            {
+                pxEntry->cOwner[ ucChar ] = *pcName;
+            }
+
+            if(pxLastStackEntry != NULL)
+            {
+                pxLastStackEntry->cOwner[ ucChar ] = *pcName;
+            }
+
+            if(*pcName != 0)
+            {
+                pcName++;
+            }
+        }
+
+        pxLastStackEntry = NULL;
+    }
+    /*-----------------------------------------------------------*/
+
+    void vPortHeapLedgerTagQueue(void *pvQueue, unsigned char ucQueueType)
+    {
+        xdata HeapLedgerEntry_t *pxEntry;
+
+        /* Statically allocated queues are not in the ledger, so are not
+        found. */
+        pxEntry = prvLedgerFind(((BlockPointer_t) pvQueue) - heapBLOCK_HEADER_SIZE);
+
+        if(pxEntry != NULL)
+        {
+            if(ucQueueType == queueQUEUE_TYPE_BASE)
+            {
+                pxEntry->ucType = portHEAP_OBJECT_QUEUE;
+            }
+            else
+            {
+                pxEntry->ucType = portHEAP_OBJECT_SEMAPHORE;
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    void vPortHeapLedgerReport(void (*vPutChar)(char cChar))
+    {
+        PoolStats_t xStats;
+        xdata HeapLedgerEntry_t *pxEntry;
+        uint8_t ucPool, ucEntry, ucLargest = 0;
+
+        /* Headroom is the free blocks plus any XRAM reserved by
+        configTOTAL_HEAP_SIZE but not given to a pool. */
+        prvPutString(vPutChar, "HEAP free=", 0xff);
+        prvPutDecimal(vPutChar, (uint16_t) xPortGetFreeHeapSize());
+        prvPutString(vPutChar, " min=", 0xff);
+        prvPutDecimal(vPutChar, (uint16_t) xPortGetMinimumEverFreeHeapSize());
+        prvPutString(vPutChar, " spare=", 0xff);
+        prvPutDecimal(vPutChar, (uint16_t)(configTOTAL_HEAP_SIZE - heapPOOL_END_OFFSET));
+
+        for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+        {
+            if(xPoolState[ ucPool ].ucBlocksFree != 0)
+            {
+                ucLargest = xPoolDescriptors[ ucPool ].ucBlockSize;
+            }
+        }
+
+        prvPutString(vPutChar, " largest=", 0xff);
+        prvPutDecimal(vPutChar, ucLargest);
+        prvPutString(vPutChar, " lost=", 0xff);
+        prvPutDecimal(vPutChar, ucLedgerOverflows);
+        prvPutString(vPutChar, "\r\n", 0xff);
+
+        /* One line per pool: size x count, free, low water mark, failed and
+        overflowed requests, bytes lost to internal fragmentation. */
+        for(ucPool = 0; ucPool < portNUM_POOLS; ucPool++)
+        {
+            vPortGetPoolStats(ucPool, &xStats);
+
+            vPutChar('P');
+            prvPutDecimal(vPutChar, ucPool);
+            vPutChar(' ');
+            prvPutDecimal(vPutChar, xStats.ucBlockSize);
+            vPutChar('x');
+            prvPutDecimal(vPutChar, xStats.ucBlockCount);
+            prvPutString(vPutChar, " free=", 0xff);
+            prvPutDecimal(vPutChar, xStats.ucBlocksFree);
+            prvPutString(vPutChar, " min=", 0xff);
+            prvPutDecimal(vPutChar, xStats.ucMinimumBlocksFree);
+            prvPutString(vPutChar, " fail=", 0xff);
+            prvPutDecimal(vPutChar, xStats.ucFailedRequests);
+            prvPutString(vPutChar, " ovf=", 0xff);
+            prvPutDecimal(vPutChar, xStats.ucOverflowAllocations);
+            prvPutString(vPutChar, " waste=", 0xff);
+            prvPutDecimal(vPutChar, xStats.usBytesWasted);
+            prvPutString(vPutChar, "\r\n", 0xff);
+        }
+
+        /* One line per live block: type, bytes requested, owner.  The scheduler
+        is suspended one entry at a time so a slow vPutChar() does not hold
+        off the other tasks for the whole report. */
+        for(ucEntry = 0; ucEntry < configHEAP_LEDGER_LENGTH; ucEntry++)
+        {
+            HeapLedgerEntry_t xEntry;
+
+            pxEntry = &xHeapLedger[ ucEntry ];
+
+            vTaskSuspendAll();
+            {
+                vPortIRAMCopyFromX(&xEntry, pxEntry, sizeof(HeapLedgerEntry_t));
+            }
+            (void) xTaskResumeAll();
+
+            if(xEntry.pucBlock != NULL)
+            {
+                prvPutString(vPutChar, cObjectNames[ xEntry.ucType ], 3);
+                vPutChar(' ');
+                prvPutDecimal(vPutChar, xEntry.ucSize);
+                vPutChar(' ');
+                for(ucPool = 0; (ucPool < portHEAP_LEDGER_OWNER_LEN) && (xEntry.cOwner[ ucPool ] != 0); ucPool++)
+                {
+                    vPutChar(xEntry.cOwner[ ucPool ]);
+                }
+                prvPutString(vPutChar, "\r\n", 0xff);
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static void prvLedgerAdd(BlockPointer_t pucBlock, uint8_t ucSize, uint8_t ucType)
+    {
+        xdata HeapLedgerEntry_t *pxEntry;
+
+        /* Called with the scheduler suspended. */
+        pxEntry = prvLedgerFind(NULL);
+
+        if(pxEntry != NULL)
+        {
+            pxEntry->pucBlock = pucBlock;
+            pxEntry->ucSize = ucSize;
+            pxEntry->ucType = ucType;
+
+            vPortXCopy(pxEntry->cOwner, cCurrentOwner, portHEAP_LEDGER_OWNER_LEN);
+
+            if(ucType == portHEAP_OBJECT_STACK)
+            {
+                pxLastStackEntry = pxEntry;
+            }
+        }
+        else if(ucLedgerOverflows != 0xff)
+        {
+            ucLedgerOverflows++;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static void prvLedgerRemove(BlockPointer_t pucBlock)
+    {
+        xdata HeapLedgerEntry_t *pxEntry;
+
+        /* Called with the scheduler suspended. */
+        pxEntry = prvLedgerFind(pucBlock);
+
+        if(pxEntry != NULL)
+        {
+            pxEntry->pucBlock = NULL;
+
+            if(pxEntry == pxLastStackEntry)
+            {
+                pxLastStackEntry = NULL;
+            }
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static xdata HeapLedgerEntry_t *prvLedgerFind(BlockPointer_t pucBlock)
+    {
+        uint8_t ucEntry;
+
+        for(ucEntry = 0; ucEntry < configHEAP_LEDGER_LENGTH; ucEntry++)
+        {
+            if(xHeapLedger[ ucEntry ].pucBlock == pucBlock)
+            {
+                return &xHeapLedger[ ucEntry ];
+            }
+        }
+
+        return NULL;
+    }
+    /*-----------------------------------------------------------*/
+
+    static void prvPutString(void (*vPutChar)(char cChar), code const char *pcString, uint8_t ucMaxLength)
+    {
+        while((*pcString != 0) && (ucMaxLength != 0))
+        {
+            vPutChar(*pcString);
+            pcString++;
+            ucMaxLength--;
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+    static void prvPutDecimal(void (*vPutChar)(char cChar), uint16_t usValue)
+    {
+        char cDigits[ 5 ];
+        uint8_t ucCount = 0;
+
+        do
+        {
+            cDigits[ ucCount ] = (char)('0' + (usValue % 10));
+            usValue /= 10;
+            ucCount++;
+        } while(usValue != 0);
+
+        while(ucCount != 0)
+        {
+            ucCount--;
+            vPutChar(cDigits[ ucCount ]);
+        }
+    }
+    /*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_LEDGER */
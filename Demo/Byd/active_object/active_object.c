@@ -0,0 +1,253 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+/* SINGLE STACK ACTIVE OBJECT DISPATCHER.
+
+Every object is served by one task.  Posting an event puts it in the ring of
+the object and sets the bit of the object's priority in ucAOReady.  The task
+is only notified when ucAOReady goes from empty to not empty, so a burst of
+events costs a single kernel call.  The rings and ucAOReady are only touched
+with interrupts disabled, for a few instructions at a time, while the dispatch
+functions run with interrupts enabled. */
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "active_object.h"
+
+#if( configUSE_ACTIVE_OBJECTS == 1 )
+
+#define aoSTACK_SIZE        configMINIMAL_STACK_SIZE
+
+/* The object registered at each priority. */
+static portXRAM_POINTER ActiveObject_t *portWARM_DATA pxAOTable[ aoMAX_PRIORITIES ];
+
+/* Bit n is set while the object at priority n has an event in its ring. */
+portWARM_DATA static uint8_t ucAOReady = 0;
+
+/* The dispatcher task, notified when ucAOReady stops being empty. */
+static TaskHandle_t xAOTask = NULL;
+
+/* The bit of ucAOReady used by each priority. */
+static code const uint8_t ucAOPriorityBits[ aoMAX_PRIORITIES ] =
+{
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+
+/* The index of the highest set bit of each nibble value. */
+static code const uint8_t ucAOHighestBit[ 16 ] =
+{
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    static StaticTask_t xAOTaskTCB;
+    static StackType_t uxAOTaskStack[ aoSTACK_SIZE ];
+#endif
+
+static portTASK_FUNCTION_PROTO(vAODispatcherTask, pvParameters);
+
+/*
+ * Add an event to the ring of pxAO.  Must be called with interrupts disabled.
+ * Returns pdTRUE if ucAOReady was empty, so the dispatcher must be notified.
+ */
+static BaseType_t prvAOInsert(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData, BaseType_t *pxPosted);
+
+/*-----------------------------------------------------------*/
+
+void vStartActiveObjects(UBaseType_t uxPriority)
+{
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    xAOTask = xTaskCreateStatic(vAODispatcherTask, "AO", aoSTACK_SIZE, NULL, uxPriority, uxAOTaskStack, &xAOTaskTCB);
+#else
+    xTaskCreate(vAODispatcherTask, "AO", aoSTACK_SIZE, NULL, uxPriority, &xAOTask);
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void vAOCreate(ActiveObject_t *pxAO, AODispatchFunction_t pxDispatch, uint8_t ucPriority, AOEvent_t *pxEventStorage, uint8_t ucLength)
+{
+    configASSERT(ucPriority < aoMAX_PRIORITIES);
+    configASSERT(pxAOTable[ ucPriority ] == NULL);
+    configASSERT(ucLength != 0);
+
+    pxAO->pxDispatch = pxDispatch;
+    pxAO->pxEvents = (portXRAM_POINTER AOEvent_t *) pxEventStorage;
+    pxAO->ucLength = ucLength;
+    pxAO->ucHead = 0;
+    pxAO->ucCount = 0;
+    pxAO->ucPriority = ucPriority;
+    pxAO->ucDropped = 0;
+
+    portENTER_CRITICAL();
+    {
+        pxAOTable[ ucPriority ] = (portXRAM_POINTER ActiveObject_t *) pxAO;
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAOInsert(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData, BaseType_t *pxPosted)
+{
+    uint8_t ucIndex;
+    BaseType_t xWasIdle = pdFALSE;
+
+    if(pxAO->ucCount < pxAO->ucLength)
+    {
+        ucIndex = pxAO->ucHead + pxAO->ucCount;
+        if(ucIndex >= pxAO->ucLength)
+        {
+            ucIndex -= pxAO->ucLength;
+        }
+
+        pxAO->pxEvents[ ucIndex ].ucSignal = ucSignal;
+        pxAO->pxEvents[ ucIndex ].ucData = ucData;
+        pxAO->ucCount++;
+
+        if(ucAOReady == 0)
+        {
+            xWasIdle = pdTRUE;
+        }
+        ucAOReady |= ucAOPriorityBits[ pxAO->ucPriority ];
+
+        *pxPosted = pdPASS;
+    }
+    else
+    {
+        pxAO->ucDropped++;
+        *pxPosted = pdFAIL;
+    }
+
+    return xWasIdle;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAOPost(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData)
+{
+    BaseType_t xPosted, xWasIdle;
+
+    portENTER_CRITICAL();
+    {
+        xWasIdle = prvAOInsert(pxAO, ucSignal, ucData, &xPosted);
+    }
+    portEXIT_CRITICAL();
+
+    if((xWasIdle != pdFALSE) && (xAOTask != NULL))
+    {
+        xTaskNotifyGive(xAOTask);
+    }
+
+    return xPosted;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAOPostFromISR(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    BaseType_t xPosted, xWasIdle;
+
+    /* An interrupt of a higher priority may also post, so the ring is still
+    updated with interrupts disabled. */
+    portENTER_CRITICAL();
+    {
+        xWasIdle = prvAOInsert(pxAO, ucSignal, ucData, &xPosted);
+    }
+    portEXIT_CRITICAL();
+
+    if((xWasIdle != pdFALSE) && (xAOTask != NULL))
+    {
+        vTaskNotifyGiveFromISR(xAOTask, pxHigherPriorityTaskWoken);
+    }
+
+    return xPosted;
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION(vAODispatcherTask, pvParameters)
+{
+    ActiveObject_t *pxAO;
+    AOEvent_t xEvent;
+    uint8_t ucPriority;
+
+    /* The parameters are not used. */
+    (void) pvParameters;
+
+    for(;;)
+    {
+        /* Sleep until an event is posted to an object with an empty ring. */
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        for(;;)
+        {
+            /* Take the oldest event of the highest priority object. */
+            portENTER_CRITICAL();
+            {
+                if(ucAOReady == 0)
+                {
+                    pxAO = NULL;
+                }
+                else
+                {
+                    if(ucAOReady & 0xf0)
+                    {
+                        ucPriority = ucAOHighestBit[ ucAOReady >> 4 ] + 4;
+                    }
+                    else
+                    {
+                        ucPriority = ucAOHighestBit[ ucAOReady ];
+                    }
+
+                    pxAO = pxAOTable[ ucPriority ];
+                    xEvent = pxAO->pxEvents[ pxAO->ucHead ];
+
+                    if(++pxAO->ucHead >= pxAO->ucLength)
+                    {
+                        pxAO->ucHead = 0;
+                    }
+
+                    if(--pxAO->ucCount == 0)
+                    {
+                        ucAOReady &= (uint8_t) ~ucAOPriorityBits[ ucPriority ];
+                    }
+                }
+            }
+            portEXIT_CRITICAL();
+
+            if(pxAO == NULL)
+            {
+                /* Every ring is empty.  Anything posted from now on notifies
+                the task again. */
+                break;
+            }
+
+            /* Run the handler to completion.  Events posted meanwhile,
+            including by the handler itself, are picked up on the next pass
+            in priority order. */
+            pxAO->pxDispatch(pxAO, &xEvent);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_ACTIVE_OBJECTS */
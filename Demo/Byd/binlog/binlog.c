@@ -0,0 +1,224 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+/* DEFERRED BINARY LOG.
+
+Records are written to a single XRAM ring with interrupts disabled, so tasks
+and ISRs can log at any time and a record is never split by another.  The
+ring indices are single bytes that run freely, as in serial.c, so the number
+of bytes held is always ( head - tail ) in eight bit arithmetic.  The log task
+is the only reader.  It hands the oldest unbroken run of bytes to the serial
+driver as a Tx descriptor, so the ring is sent without being copied, and only
+moves the tail on once the driver has sent them.
+
+Every record on the wire is:
+
+    binlogSYNC, length of the arguments, ID (2 bytes), tick count (2 bytes),
+    arguments, check byte
+
+with multi-byte values least significant byte first.  The check byte makes
+the bytes from the length to the check byte add up to zero, so the host can
+find the start of the next record again after losing bytes. */
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "serial.h"
+#include "binlog.h"
+
+#if( configUSE_BINARY_LOG == 1 )
+
+/* Ring size, a power of two no larger than 128. */
+#ifndef configBINLOG_BUFFER_SIZE
+    #define configBINLOG_BUFFER_SIZE    (64)
+#endif
+
+#define binlogBUFFER_MASK       ((uint8_t) (configBINLOG_BUFFER_SIZE - 1))
+
+/* Bytes in a record besides the arguments. */
+#define binlogOVERHEAD          ((uint8_t) 7)
+
+#define binlogSTACK_SIZE        configMINIMAL_STACK_SIZE
+
+/* How long the log task sleeps when the ring is empty. */
+#define binlogIDLE_TICKS        ((TickType_t) 20 / portTICK_PERIOD_MS)
+
+/* How often the table hash is logged, so a host that starts listening late
+can still check it has the table that matches the build. */
+#define binlogTABLE_TICKS       ((TickType_t) 5000 / portTICK_PERIOD_MS)
+
+portCOLD_DATA static uint8_t ucBinLogBuffer[ configBINLOG_BUFFER_SIZE ];
+portWARM_DATA static volatile uint8_t ucBinLogHead = 0;
+portWARM_DATA static volatile uint8_t ucBinLogTail = 0;
+
+/* Records dropped because the ring was full, since last logged. */
+portWARM_DATA static volatile uint16_t usBinLogDropped = 0;
+
+static xComPortHandle xBinLogPort = NULL;
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    static StaticTask_t xBinLogTaskTCB;
+    static StackType_t uxBinLogTaskStack[ binlogSTACK_SIZE ];
+#endif
+
+static portTASK_FUNCTION_PROTO(vBinLogTask, pvParameters);
+
+/*-----------------------------------------------------------*/
+
+void vStartBinLogTask(UBaseType_t uxPriority, xComPortHandle pxPort)
+{
+    xBinLogPort = pxPort;
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    xTaskCreateStatic(vBinLogTask, "Log", binlogSTACK_SIZE, NULL, uxPriority, uxBinLogTaskStack, &xBinLogTaskTCB);
+#else
+    xTaskCreate(vBinLogTask, "Log", binlogSTACK_SIZE, NULL, uxPriority, NULL);
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void vBinLogWrite(uint16_t usID, uint8_t ucSizes, uint32_t ulArg1, uint32_t ulArg2, uint32_t ulArg3)
+{
+    uint8_t ucArgs, ucArg, ucByte, ucLength, ucCheck, ucHead;
+    uint8_t *pucArg;
+    TickType_t xTicks;
+
+    /* Add up the argument sizes. */
+    ucArgs = ucSizes >> 6;
+    ucLength = 0;
+    for(ucArg = 0; ucArg < ucArgs; ucArg++)
+    {
+        ucLength += ((ucSizes >> (ucArg << 1)) & 0x03) + 1;
+    }
+
+    portENTER_CRITICAL();
+    {
+        if((uint8_t) (configBINLOG_BUFFER_SIZE - (uint8_t) (ucBinLogHead - ucBinLogTail)) < (uint8_t) (ucLength + binlogOVERHEAD))
+        {
+            if(usBinLogDropped != 0xffff)
+            {
+                usBinLogDropped++;
+            }
+        }
+        else
+        {
+            xTicks = xTaskGetTickCountFromISR();
+            ucHead = ucBinLogHead;
+
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = binlogSYNC;
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = ucLength;
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = (uint8_t) usID;
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = (uint8_t) (usID >> 8);
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = (uint8_t) xTicks;
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = (uint8_t) (xTicks >> 8);
+            ucCheck = ucLength + (uint8_t) usID + (uint8_t) (usID >> 8) + (uint8_t) xTicks + (uint8_t) (xTicks >> 8);
+
+            /* The low bytes of each argument, which come first in memory. */
+            for(ucArg = 0; ucArg < ucArgs; ucArg++)
+            {
+                pucArg = (ucArg == 0) ? (uint8_t *) &ulArg1 : ((ucArg == 1) ? (uint8_t *) &ulArg2 : (uint8_t *) &ulArg3);
+                ucByte = ((ucSizes >> (ucArg << 1)) & 0x03) + 1;
+                while(ucByte-- != 0)
+                {
+                    ucCheck += *pucArg;
+                    ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = *pucArg++;
+                }
+            }
+
+            ucBinLogBuffer[ ucHead++ & binlogBUFFER_MASK ] = (uint8_t) (0 - ucCheck);
+
+            /* Publish the whole record at once. */
+            ucBinLogHead = ucHead;
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION(vBinLogTask, pvParameters)
+{
+    TickType_t xLastTable;
+    uint16_t usDropped;
+    uint8_t ucTail, ucCount, ucRun;
+
+    /* Just to prevent compiler warnings. */
+    (void) pvParameters;
+
+    vBinLogWrite(binlogID_TABLE, (uint8_t) (0x40 | binlogSIZE(uint16_t)), binlogTABLE_HASH, 0, 0);
+    xLastTable = xTaskGetTickCount();
+
+    for(;;)
+    {
+        if(usBinLogDropped != 0)
+        {
+            portENTER_CRITICAL();
+            {
+                usDropped = usBinLogDropped;
+                usBinLogDropped = 0;
+            }
+            portEXIT_CRITICAL();
+
+            vBinLogWrite(binlogID_DROPPED, (uint8_t) (0x40 | binlogSIZE(uint16_t)), usDropped, 0, 0);
+        }
+
+        if((TickType_t) (xTaskGetTickCount() - xLastTable) >= binlogTABLE_TICKS)
+        {
+            vBinLogWrite(binlogID_TABLE, (uint8_t) (0x40 | binlogSIZE(uint16_t)), binlogTABLE_HASH, 0, 0);
+            xLastTable = xTaskGetTickCount();
+        }
+
+        ucTail = ucBinLogTail;
+        ucCount = (uint8_t) (ucBinLogHead - ucTail);
+
+        if(ucCount == 0)
+        {
+            vTaskDelay(binlogIDLE_TICKS);
+            continue;
+        }
+
+        /* Send up to the end of the buffer, the rest goes next time round. */
+        ucRun = configBINLOG_BUFFER_SIZE - (ucTail & binlogBUFFER_MASK);
+        if(ucRun > ucCount)
+        {
+            ucRun = ucCount;
+        }
+
+        if(xSerialWriteDescriptor(xBinLogPort, &ucBinLogBuffer[ ucTail & binlogBUFFER_MASK ], ucRun, serDESCRIPTOR_XRAM) == pdPASS)
+        {
+            (void) xSerialWaitForDescriptor(xBinLogPort, portMAX_DELAY);
+
+            /* The bytes are sent, so the writers can have them back. */
+            ucBinLogTail = ucTail + ucRun;
+        }
+        else
+        {
+            vTaskDelay(1);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_BINARY_LOG */
@@ -0,0 +1,86 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef HEAP_POOL_H
+#define HEAP_POOL_H
+
+/* Number of size classes managed by MemMang/heap_pool.c.  The block size and
+block count of each class is set by the configPOOL_n_BLOCK_SIZE and
+configPOOL_n_BLOCK_COUNT definitions in FreeRTOSConfig.h. */
+#define portNUM_POOLS       ( 4 )
+
+/* Usage snapshot of a single pool, as returned by vPortGetPoolStats(). */
+typedef struct xPOOL_STATS
+{
+    uint8_t ucBlockSize;            /* Payload bytes per block. */
+    uint8_t ucBlockCount;           /* Total number of blocks in the pool. */
+    uint8_t ucBlocksFree;           /* Blocks currently on the free list. */
+    uint8_t ucMinimumBlocksFree;    /* Low water mark of ucBlocksFree. */
+    uint8_t ucFailedRequests;       /* Requests that fitted this pool but found it (and every larger pool) empty. */
+    uint8_t ucOverflowAllocations;  /* Blocks taken from this pool because a smaller pool was exhausted. */
+    uint16_t usBytesRequested;      /* Sum of the sizes requested for the blocks in use. */
+    uint16_t usBytesWasted;         /* Internal fragmentation - block bytes in use but not requested. */
+} PoolStats_t;
+
+/* Fill *pxStats with the current state of pool uxPool (0 to portNUM_POOLS - 1). */
+void vPortGetPoolStats(UBaseType_t uxPool, PoolStats_t *pxStats);
+
+#ifndef configUSE_HEAP_LEDGER
+    #define configUSE_HEAP_LEDGER       0
+#endif
+
+/* Object types recorded by the allocation ledger. */
+#define portHEAP_OBJECT_UNKNOWN         ( 0 )
+#define portHEAP_OBJECT_TCB             ( 1 )
+#define portHEAP_OBJECT_STACK           ( 2 )
+#define portHEAP_OBJECT_QUEUE           ( 3 )
+#define portHEAP_OBJECT_SEMAPHORE       ( 4 )
+
+/* Number of owner tag characters kept per ledger entry. */
+#define portHEAP_LEDGER_OWNER_LEN       ( 4 )
+
+#if( configUSE_HEAP_LEDGER == 1 )
+
+    /* Set the owner tag recorded against the queues and semaphores allocated
+    from now on.  Tasks are always tagged with their own name. */
+    void vPortHeapLedgerSetOwner(const char *pcOwner);
+
+    /* Write the XRAM budget report one character at a time through
+    vPutChar().  The report lists the heap headroom, the largest free block,
+    the state of every pool and then one line per live allocation. */
+    void vPortHeapLedgerReport(void (*vPutChar)(char cChar));
+
+    #define portHEAP_LEDGER_OWNER( pcOwner )    vPortHeapLedgerSetOwner(pcOwner)
+
+#else
+
+    #define portHEAP_LEDGER_OWNER( pcOwner )
+
+#endif /* configUSE_HEAP_LEDGER */
+
+#endif /* HEAP_POOL_H */
@@ -33,9 +33,16 @@
 #include "task.h"
 #include "i2c_master.h"
 
+/* This file is listed in PORT_SINGLE_CONTEXT_SOURCES and is built without
+--stack-auto.  The bus is only driven by the master test task, so the bit-bang
+helpers keep their frames in XRAM and only the public entry points are
+reentrant.  Nothing in it may call the kernel, see portmacro.h.  The timer
+driven transfers of configI2C_MASTER_USE_TIMER, which block on a task
+notification, are in i2c_master_timer.c. */
+
 /*-----------------------------------------------------------*/
 
-void xI2CMasterInitMinimal(void)
+void xI2CMasterInitMinimal(void) portREENTRANT
 {
     uint8_t ucOriginalSFRPage;
 
@@ -48,6 +55,10 @@ void xI2CMasterInitMinimal(void)
         OUT_SCL();
         SET_SDA();
         SET_SCL();
+
+#if (configI2C_MASTER_USE_TIMER == 1)
+        vI2CMasterTimerInit();
+#endif
     }
     portEXIT_CRITICAL();
 
@@ -56,7 +67,7 @@ void xI2CMasterInitMinimal(void)
 
 /*-----------------------------------------------------------*/
 
-static void Delay(uint8_t time)// unit: 10us
+static portSINGLE_CONTEXT void Delay(uint8_t time)// unit: 10us
 {
     uint8_t a, b;
     for(b = time; b > 0; b--)
@@ -67,7 +78,7 @@ static void Delay(uint8_t time)// unit: 10us
 
 /*-----------------------------------------------------------*/
 
-static void Start()
+static portSINGLE_CONTEXT void Start()
 {
     OUT_SDA();
     SET_SDA();
@@ -81,7 +92,7 @@ static void Start()
 
 /*-----------------------------------------------------------*/
 
-static void Stop()
+static portSINGLE_CONTEXT void Stop()
 {
     CLR_SCL();
     OUT_SDA();
@@ -94,7 +105,7 @@ static void Stop()
 
 /*-----------------------------------------------------------*/
 
-static uint8_t ReceiveByte()
+static portSINGLE_CONTEXT uint8_t ReceiveByte()
 {
     uint8_t i;
     uint8_t buffer = 0;
@@ -126,7 +137,7 @@ static uint8_t ReceiveByte()
 
 /*-----------------------------------------------------------*/
 
-static bool SendByteAndGetNACK(uint8_t dataToSend)
+static portSINGLE_CONTEXT bool SendByteAndGetNACK(uint8_t dataToSend)
 {
     uint8_t i;
     bool ack;
@@ -171,7 +182,7 @@ static bool SendByteAndGetNACK(uint8_t dataToSend)
 
 /*-----------------------------------------------------------*/
 
-static void Respond(uint8_t ACKSignal)
+static portSINGLE_CONTEXT void Respond(uint8_t ACKSignal)
 {
     OUT_SDA();
     CLR_SDA();
@@ -192,7 +203,7 @@ static void Respond(uint8_t ACKSignal)
 
 /*-----------------------------------------------------------*/
 
-void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData)
+void vI2CMasterWriteDataPolled(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData) portREENTRANT
 {
     uint8_t i;
 
@@ -217,7 +228,7 @@ void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t length
 
 /*-----------------------------------------------------------*/
 
-void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData)
+void vI2CMasterReadDataPolled(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData) portREENTRANT
 {
     uint8_t i;
 
@@ -243,15 +254,30 @@ void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfDat
 }
 
 /*-----------------------------------------------------------*/
+#if (configI2C_MASTER_USE_TIMER == 0)
 
-void vI2CMasterClose(void)
+void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData) portREENTRANT
 {
+    vI2CMasterWriteDataPolled(deviceAddr, dataSource, lengthOfData);
+}
 
+/*-----------------------------------------------------------*/
+
+void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData) portREENTRANT
+{
+    vI2CMasterReadDataPolled(deviceAddr, target, lengthOfData);
 }
 
 /*-----------------------------------------------------------*/
 
+#endif /* configI2C_MASTER_USE_TIMER */
 
+void vI2CMasterClose(void) portREENTRANT
+{
+
+}
+
+/*-----------------------------------------------------------*/
 
 
 
@@ -0,0 +1,312 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+/* TIMER DRIVEN TRANSFERS FOR THE I2C MASTER DRIVER, see i2c_master.c */
+#include <stdlib.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#include "i2c_master.h"
+
+/* This file is built with --stack-auto like the rest of the kernel.  Its task
+side calls ulTaskNotifyTake() and xTaskGetCurrentTaskHandle(), and its
+interrupt runs vTaskNotifyGiveFromISR() on every transfer, so none of it may be
+compiled into the static frames of the single-context bit-bang code in
+i2c_master.c. */
+
+/* With configI2C_MASTER_USE_TIMER set vI2CMasterWriteData() and
+vI2CMasterReadData() do not clock the bus themselves.  They set up the
+transfer, start timer 1 and block on a task notification.  Timer 1 reloads
+itself every configI2C_MASTER_PHASE_US and each of its interrupts moves the
+bus on by one phase - one SCL edge, or one step of the start or stop
+condition - so the processor is free for other tasks between edges instead of
+spinning in Delay().  SDA is read just before the falling edge of SCL, after
+the line has been high for a whole phase, and is driven just after it, which
+is the timing the busy-wait code used.  The last interrupt of the transfer
+stops the timer and notifies the task.
+
+The busy-wait versions are kept in i2c_master.c as
+vI2CMasterWriteDataPolled() and vI2CMasterReadDataPolled(), for comparison by the i2ctest.c benchmark. */
+#if (configI2C_MASTER_USE_TIMER == 1)
+
+#if (configSERIAL_USE_FRAME_MODE == 1) || (configSERIAL_USE_RX_BUFFERS == 1)
+    #error Timer 1 is used by the serial driver, so configI2C_MASTER_USE_TIMER must be 0
+#endif
+
+/* Input clock of timer 1, one count per machine cycle of the CPU. */
+#ifndef configI2C_MASTER_TIMER_HZ
+    #define configI2C_MASTER_TIMER_HZ   (configCPU_CLOCK_HZ / 12UL)
+#endif
+
+/* Timer 1 counts per phase, which must fit its 8 bit reload. */
+#define i2cTIMER1_COUNTS                ((configI2C_MASTER_TIMER_HZ * configI2C_MASTER_PHASE_US) / 1000000UL)
+
+#if (i2cTIMER1_COUNTS < 1) || (i2cTIMER1_COUNTS > 256)
+    #error configI2C_MASTER_PHASE_US is out of the range of timer 1
+#endif
+
+#define i2cTIMER1_RELOAD                ((uint8_t) (256UL - i2cTIMER1_COUNTS))
+
+/* Timer 1 in mode 2, 8 bit auto-reload. */
+#define i2cTIMER1_MODE_AUTO_RELOAD      ((uint8_t) 0x20)
+#define i2cTIMER1_MODE_MASK             ((uint8_t) 0xf0)
+
+/* SDA direction.  IN_SDA() and OUT_SDA() also select the pin's function
+through REG_ADDR, which only needs doing once and which the interrupt must not
+change under the code it interrupted, so the interrupt only sets TRISF. */
+#define i2cRELEASE_SDA()                TRISF |= 0x20
+#define i2cDRIVE_SDA()                  TRISF &= ~0x20
+
+/* What the next timer interrupt does. */
+#define i2cPHASE_IDLE                   ((uint8_t) 0)   /* Nothing, the timer is stopped. */
+#define i2cPHASE_START                  ((uint8_t) 1)   /* Pull SDA low while SCL is high. */
+#define i2cPHASE_SCL_HIGH               ((uint8_t) 2)   /* Raise SCL. */
+#define i2cPHASE_SCL_LOW                ((uint8_t) 3)   /* Read SDA, lower SCL, set up the next bit. */
+#define i2cPHASE_STOP_SCL_HIGH          ((uint8_t) 4)   /* Raise SCL with SDA held low. */
+#define i2cPHASE_STOP_SDA_HIGH          ((uint8_t) 5)   /* Raise SDA while SCL is high. */
+
+/* Transfer state, used on every phase by the timer interrupt and so kept in
+the pdata page. */
+portWARM_DATA static volatile uint8_t ucI2CPhase;
+portWARM_DATA static uint8_t ucI2CClocks;           /* SCL pulses of the current byte so far, the ninth is the ACK. */
+portWARM_DATA static uint8_t ucI2CShift;            /* Byte being sent or received, MSB first. */
+portWARM_DATA static uint8_t ucI2CRemaining;        /* Data bytes still to start after the current one. */
+portWARM_DATA static uint8_t ucI2CSending;          /* pdTRUE while the current byte goes to the slave. */
+portWARM_DATA static uint8_t ucI2CReading;          /* pdTRUE for a read transfer. */
+static uint8_t *portWARM_DATA pucI2CData;
+portWARM_DATA static TaskHandle_t xI2CMasterTask;
+
+/*
+ * Clock the address and then ucLength bytes to or from pucData, and block
+ * until the stop condition is on the bus.
+ */
+static void prvTimerTransfer(uint8_t ucAddress, uint8_t *pucData, uint8_t ucLength);
+
+/*-----------------------------------------------------------*/
+
+void vI2CMasterTimerInit(void) portREENTRANT
+{
+    /* Timer 1 reloads itself every phase, and only runs during a transfer.
+    Called by xI2CMasterInitMinimal() inside its critical section. */
+    TR1 = 0;
+    TF1 = 0;
+    TMOD = (TMOD & ~i2cTIMER1_MODE_MASK) | i2cTIMER1_MODE_AUTO_RELOAD;
+    TH1 = i2cTIMER1_RELOAD;
+    TL1 = i2cTIMER1_RELOAD;
+    ucI2CPhase = i2cPHASE_IDLE;
+    ET1 = 1;
+}
+
+/*-----------------------------------------------------------*/
+
+void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData) portREENTRANT
+{
+    prvTimerTransfer(deviceAddr & ~0x01, dataSource, lengthOfData);
+}
+
+/*-----------------------------------------------------------*/
+
+void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData) portREENTRANT
+{
+    prvTimerTransfer(deviceAddr | 0x01, target, lengthOfData);
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTimerTransfer(uint8_t ucAddress, uint8_t *pucData, uint8_t ucLength)
+{
+    ucI2CClocks = 0;
+    ucI2CShift = ucAddress;
+    ucI2CRemaining = ucLength;
+    ucI2CSending = pdTRUE;
+    ucI2CReading = (ucAddress & 0x01) ? pdTRUE : pdFALSE;
+    pucI2CData = pucData;
+    xI2CMasterTask = xTaskGetCurrentTaskHandle();
+
+    /* Bus idle, the start condition goes out on the first interrupt. */
+    OUT_SDA();
+    SET_SDA();
+    SET_SCL();
+
+    portENTER_CRITICAL();
+    {
+        ucI2CPhase = i2cPHASE_START;
+        TL1 = i2cTIMER1_RELOAD;
+        TF1 = 0;
+        TR1 = 1;
+    }
+    portEXIT_CRITICAL();
+
+    /* The interrupt notifies this task when the stop condition is done.  Any
+    other notification just goes round the loop again. */
+    while(ucI2CPhase != i2cPHASE_IDLE)
+    {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vI2CMasterTimerISR(void) interrupt(3)
+{
+    uint8_t ucSDA;
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    /* 8051 port interrupt routines MUST be placed within a critical section
+    if taskYIELD() is used within the ISR! */
+
+    portENTER_CRITICAL();
+    {
+        switch(ucI2CPhase)
+        {
+            case i2cPHASE_START:
+                CLR_SDA();
+                ucI2CPhase = i2cPHASE_SCL_LOW;
+                break;
+
+            case i2cPHASE_SCL_HIGH:
+                SET_SCL();
+                ucI2CClocks++;
+                ucI2CPhase = i2cPHASE_SCL_LOW;
+                break;
+
+            case i2cPHASE_SCL_LOW:
+                /* Read the bit of the clock that is ending before the slave
+                can change it. */
+                ucSDA = 0;
+                if(SDA())
+                {
+                    ucSDA = 1;
+                }
+                CLR_SCL();
+                ucI2CPhase = i2cPHASE_SCL_HIGH;
+
+                if((ucI2CSending == pdFALSE) && (ucI2CClocks != 0) && (ucI2CClocks <= 8))
+                {
+                    ucI2CShift = (ucI2CShift << 1) | ucSDA;
+                    if(ucI2CClocks == 8)
+                    {
+                        *pucI2CData++ = ucI2CShift;
+                    }
+                }
+                else if(ucI2CClocks == 9)
+                {
+                    /* The ACK clock has ended the byte. */
+                    ucI2CClocks = 0;
+
+                    if(((ucI2CSending != pdFALSE) && (ucSDA != ACK)) || (ucI2CRemaining == 0))
+                    {
+                        /* NACKed by the slave, or the last byte.  Hold SDA low
+                        for the stop condition. */
+                        i2cDRIVE_SDA();
+                        CLR_SDA();
+                        ucI2CPhase = i2cPHASE_STOP_SCL_HIGH;
+                        break;
+                    }
+
+                    ucI2CRemaining--;
+
+                    if(ucI2CReading != pdFALSE)
+                    {
+                        ucI2CSending = pdFALSE;
+                        ucI2CShift = 0;
+                    }
+                    else
+                    {
+                        ucI2CShift = *pucI2CData++;
+                    }
+                }
+
+                /* Set up SDA for the next clock. */
+                if(ucI2CClocks < 8)
+                {
+                    if(ucI2CSending != pdFALSE)
+                    {
+                        i2cDRIVE_SDA();
+                        if(ucI2CShift & 0x80)
+                        {
+                            SET_SDA();
+                        }
+                        else
+                        {
+                            CLR_SDA();
+                        }
+                        ucI2CShift <<= 1;
+                    }
+                    else
+                    {
+                        i2cRELEASE_SDA();
+                    }
+                }
+                else if(ucI2CSending != pdFALSE)
+                {
+                    /* Let the slave ACK. */
+                    i2cRELEASE_SDA();
+                }
+                else
+                {
+                    /* ACK every byte read but the last. */
+                    i2cDRIVE_SDA();
+                    if(ucI2CRemaining == 0)
+                    {
+                        SET_SDA();
+                    }
+                    else
+                    {
+                        CLR_SDA();
+                    }
+                }
+                break;
+
+            case i2cPHASE_STOP_SCL_HIGH:
+                SET_SCL();
+                ucI2CPhase = i2cPHASE_STOP_SDA_HIGH;
+                break;
+
+            case i2cPHASE_STOP_SDA_HIGH:
+                SET_SDA();
+                TR1 = 0;
+                ucI2CPhase = i2cPHASE_IDLE;
+                vTaskNotifyGiveFromISR(xI2CMasterTask, &xHigherPriorityTaskWoken);
+                break;
+
+            default:
+                TR1 = 0;
+                break;
+        }
+
+        if(xHigherPriorityTaskWoken)
+        {
+            portYIELD();
+        }
+    }
+    portEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+#endif /* configI2C_MASTER_USE_TIMER */
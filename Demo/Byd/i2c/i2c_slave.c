@@ -32,21 +32,40 @@
 #include "task.h"
 #include "semphr.h"
 #include "i2c_slave.h"
+#include "active_object.h"
 
 //#define I2C_PORT 1 // PE4/5
 #define I2C_PORT 0 // PC4/5
 #define I2C_ADDRESS 0xC0
 
-QueueHandle_t xSlaveReceivedQueue;
-QueueHandle_t xSlaveTransmidQueue;
+/* Longest queue xI2CSlaveInitMinimal() can be asked for when the queues are
+statically allocated. */
+#define I2C_MAX_QUEUE_LENGTH 24
 
-static uint8_t I2CSlaveTransmidBufferIndex;
-static uint8_t I2CSlaveReceivedBufferIndex;
-static uint8_t I2CTransmitedBufferSize;
-static uint8_t I2CReceivedBufferSize;
+portWARM_DATA QueueHandle_t xSlaveReceivedQueue;
+portWARM_DATA QueueHandle_t xSlaveTransmidQueue;
 
-extern SemaphoreHandle_t xSlaveReceivedSemaphore;
-extern SemaphoreHandle_t xSlaveTransmidSemaphore;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+static StaticQueue_t xSlaveReceivedQueueBuffer;
+static StaticQueue_t xSlaveTransmidQueueBuffer;
+static uint8_t ucSlaveReceivedStorage[I2C_MAX_QUEUE_LENGTH];
+static uint8_t ucSlaveTransmidStorage[I2C_MAX_QUEUE_LENGTH];
+#endif
+
+portWARM_DATA static uint8_t I2CSlaveTransmidBufferIndex;
+portWARM_DATA static uint8_t I2CSlaveReceivedBufferIndex;
+portWARM_DATA static uint8_t I2CTransmitedBufferSize;
+portWARM_DATA static uint8_t I2CReceivedBufferSize;
+
+#if (configUSE_ACTIVE_OBJECTS == 1)
+/* When not NULL received bytes are posted to this object instead of
+xSlaveReceivedQueue. */
+static portXRAM_POINTER ActiveObject_t *portWARM_DATA pxSlaveReceivedActiveObject = NULL;
+portWARM_DATA static uint8_t ucSlaveReceivedSignal;
+#endif
+
+extern portWARM_DATA SemaphoreHandle_t xSlaveReceivedSemaphore;
+extern portWARM_DATA SemaphoreHandle_t xSlaveTransmidSemaphore;
 
 /*-----------------------------------------------------------*/
 
@@ -65,8 +84,14 @@ void xI2CSlaveInitMinimal(unsigned portBASE_TYPE uxQueueLength)
         I2CReceivedBufferSize = uxQueueLength;
         I2CTransmitedBufferSize = uxQueueLength;
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        configASSERT(uxQueueLength <= I2C_MAX_QUEUE_LENGTH);
+        xSlaveReceivedQueue = xQueueCreateStatic(uxQueueLength, (unsigned portBASE_TYPE) sizeof(uint8_t), ucSlaveReceivedStorage, &xSlaveReceivedQueueBuffer);
+        xSlaveTransmidQueue = xQueueCreateStatic(uxQueueLength, (unsigned portBASE_TYPE) sizeof(uint8_t), ucSlaveTransmidStorage, &xSlaveTransmidQueueBuffer);
+#else
         xSlaveReceivedQueue = xQueueCreate(uxQueueLength, (unsigned portBASE_TYPE) sizeof(uint8_t));
         xSlaveTransmidQueue = xQueueCreate(uxQueueLength, (unsigned portBASE_TYPE) sizeof(uint8_t));
+#endif
 
         EA = 0;
         IPL1 |= 0x08;
@@ -178,7 +203,16 @@ void vI2CISR(void) interrupt(10)
                 if(IICSTAT & 0x08) // BF
                 {
                     temp = IICBUF;
-                    xQueueSendFromISR(xSlaveReceivedQueue, &temp, &xHigherPriorityTaskWoken);
+#if (configUSE_ACTIVE_OBJECTS == 1)
+                    if(pxSlaveReceivedActiveObject != NULL)
+                    {
+                        xAOPostFromISR(pxSlaveReceivedActiveObject, ucSlaveReceivedSignal, temp, &xHigherPriorityTaskWoken);
+                    }
+                    else
+#endif
+                    {
+                        xQueueSendFromISR(xSlaveReceivedQueue, &temp, &xHigherPriorityTaskWoken);
+                    }
                     if(++I2CSlaveReceivedBufferIndex >= I2CReceivedBufferSize)
                     {
                         I2CSlaveReceivedBufferIndex = 0;
@@ -203,6 +237,22 @@ void vI2CISR(void) interrupt(10)
 
 /*-----------------------------------------------------------*/
 
+#if (configUSE_ACTIVE_OBJECTS == 1)
+
+void vI2CSlaveSetRxActiveObject(ActiveObject_t *pxAO, uint8_t ucSignal)
+{
+    portENTER_CRITICAL();
+    {
+        pxSlaveReceivedActiveObject = (portXRAM_POINTER ActiveObject_t *) pxAO;
+        ucSlaveReceivedSignal = ucSignal;
+    }
+    portEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+#endif
+
 void vI2CSlaveClose(void)
 {
 
@@ -56,10 +56,30 @@
  * the floating point libraries are correctly built to be re-enterant.  The
  * stack restrictions of the 8051 prevent the use of the standard FLOP demo
  * tasks.
+ *
+ * With configUSE_PORT_CYCLIC_EXECUTIVE set, xPortCyclicSchedule[] toggles
+ * two LEDs straight from the tick interrupt, half a major cycle apart, giving
+ * a square wave on each that can be used to check the jitter of the cyclic
+ * executive.  vErrorChecks() flags any slot overrun.
+ *
+ * With mainCREATE_QUEUE_COPY_BENCHMARK set the qcopytest.c task measures the
+ * queue item copy alongside the other tasks, see portmacro.h.
+ *
+ * With configUSE_RPC set the COM test is replaced by the binary RPC server of
+ * rpc.c on the same port, serving the commands in xRpcCommands[] to
+ * Tools/rpc_client.py.
+ *
+ * When mainCREATE_FLASH_CO_ROUTINES is set the LED is flashed by the crflash.c
+ * co-routines instead of the flash.c task.  Co-routines share the stack of
+ * the task that schedules them, here the idle task through
+ * vApplicationIdleHook(), so they need neither a stack of their own nor a
+ * context switch.  The crhook.c co-routines are created alongside them to
+ * check the co-routine queue functions used from the tick interrupt.
  */
 
 /* Standard includes. */
 #include <stdlib.h>
+#include <string.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
@@ -73,6 +93,37 @@
 #include "comtest2.h"
 #include "semtest.h"
 #include "i2ctest.h"
+#include "serial.h"
+#include "heap_pool.h"
+#include "binlog.h"
+#include "rpc.h"
+#include "port_mem.h"
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+    #include "port_cyclic.h"
+#endif
+
+#if( mainCREATE_STATIC_ALLOCATION_TEST == 1 )
+    #include "StaticAllocation.h"
+#endif
+
+#if( configUSE_ACTIVE_OBJECTS == 1 )
+    #include "aotest.h"
+#endif
+
+#if( ( mainCREATE_COMTEST_BENCHMARK == 1 ) || ( mainCREATE_I2C_BENCHMARK == 1 ) )
+    #include "idlecount.h"
+#endif
+
+#if( mainCREATE_QUEUE_COPY_BENCHMARK == 1 )
+    #include "qcopytest.h"
+#endif
+
+#if( mainCREATE_FLASH_CO_ROUTINES == 1 )
+    #include "croutine.h"
+    #include "crflash.h"
+    #include "crhook.h"
+#endif
 
 /* Demo task priorities. */
 #define mainLED_TASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
@@ -82,6 +133,14 @@
 #define mainCHECK_TASK_PRIORITY		( tskIDLE_PRIORITY + 3 )
 #define mainSEM_TEST_PRIORITY		( tskIDLE_PRIORITY + 2 )
 #define mainINTEGER_PRIORITY		tskIDLE_PRIORITY
+#define mainACTIVE_OBJECT_PRIORITY	tskIDLE_PRIORITY
+#define mainBINLOG_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define mainRPC_PRIORITY			( tskIDLE_PRIORITY + 2 )
+#define mainQUEUE_COPY_PRIORITY		( tskIDLE_PRIORITY + 1 )
+
+/* The number of 'fixed delay' co-routines, and so LEDs, used by crflash.c.
+One, as for the flash task it replaces. */
+#define mainNUM_FLASH_CO_ROUTINES	( 1 )
 
 /* Constants required to disable the watchdog. */
 #define mainDISABLE_BYTE_1			( ( unsigned char ) 0xde )
@@ -95,8 +154,23 @@ an error has been detected. */
 #define mainNO_ERROR_FLASH_PERIOD	( ( TickType_t ) 1500 / portTICK_PERIOD_MS )
 #define mainERROR_FLASH_PERIOD		( ( TickType_t ) 50 / portTICK_PERIOD_MS )
 
-/* Baud rate used by the serial port tasks. */
-#define mainCOM_TEST_BAUD_RATE		( ( unsigned long ) 115200 )
+/* Baud rate used by the serial port tasks.  A plain constant so it can be
+checked against the UART clock below. */
+#define mainCOM_TEST_BAUD_RATE		( 115200UL )
+
+#if( serialBAUD_DIVISOR( configSERIAL_CLOCK_HZ, mainCOM_TEST_BAUD_RATE ) == 0 ) || ( serialBAUD_DIVISOR( configSERIAL_CLOCK_HZ, mainCOM_TEST_BAUD_RATE ) > 1023 )
+	#error mainCOM_TEST_BAUD_RATE cannot be reached from configSERIAL_CLOCK_HZ
+#elif( serialBAUD_ERROR_PERMILLE( configSERIAL_CLOCK_HZ, mainCOM_TEST_BAUD_RATE ) > configSERIAL_MAX_BAUD_ERROR_PERMILLE )
+	#error mainCOM_TEST_BAUD_RATE is too far from any rate configSERIAL_CLOCK_HZ can give
+#endif
+
+/* Baud rate of UART1, which carries the binary log or the heap ledger report,
+and whose received characters go to the active object benchmark. */
+#define mainUART1_BAUD_RATE			ser115200
+
+/* The longest the check task waits for room in the UART1 transmit buffer while
+sending the heap ledger report. */
+#define mainHEAP_REPORT_BLOCK_TIME	( ( TickType_t ) 100 / portTICK_PERIOD_MS )
 
 /* Pass an invalid LED number to the COM test task as we don't want it to flash
 an LED.  There are only 8 LEDs (excluding the on board LED) wired in and these
@@ -104,10 +178,21 @@ are all used by the flash tasks. */
 #define mainCOM_TEST_LED			( 4 )
 #define mainI2C_TEST_LED			( 5 )
 
+/* LEDs toggled by the cyclic executive slots.  The slots run in the tick
+interrupt so cannot use vParTestToggleLED(), which suspends the scheduler, and
+write the port directly instead.  LEDs are active low. */
+#define mainCYCLIC_LED_A			( ( unsigned char ) 0x40 )
+#define mainCYCLIC_LED_B			( ( unsigned char ) 0x80 )
+
 /* Pointer passed as a parameter to vRegisterCheck() just so it has some know
 values to check for in the DPH, DPL and B registers. */
 #define mainDUMMY_POINTER		( ( xdata void * ) 0xabcd )
 
+/* Size of the XRAM buffer the heap ledger report is written to.  A longer
+report is cut short, and the characters lost are counted in
+usHeapReportDropped. */
+#define mainHEAP_REPORT_SIZE		( 256 )
+
 /* Macro that lets vErrorChecks() know that one of the tasks defined in
 main. c has detected an error.  A critical region is used around xLatchError
 as it is accessed from vErrorChecks(), which has a higher priority. */
@@ -153,10 +238,110 @@ static void vFLOPCheck1(void *pvParameters);
  */
 static void vFLOPCheck2(void *pvParameters);
 
+#if( configUSE_HEAP_LEDGER == 1 )
+/*
+ * Character output used to write the heap ledger report to cHeapReport[].
+ */
+static void prvHeapReportPutChar(char cChar);
+
+/* The heap ledger report, as text, for reading from the debugger (the
+address is in the .map file).  It is also sent out of UART1, but never out of
+UART0, as UART0 is looped back for the COM test and any other characters in the
+loop count as COM test errors. */
+xdata char cHeapReport[ mainHEAP_REPORT_SIZE ];
+uint16_t usHeapReportLength = 0;
+uint16_t usHeapReportDropped = 0;
+#endif
+
+#if( configSERIAL_USE_UART1 == 1 )
+/* UART1, opened once by main() for whichever of its users are built.  When the
+binary log is built it owns the UART1 transmitter, and text mixed into its
+frames would stop Tools/binlog.py decoding them, so the heap ledger report is
+then left in XRAM only. */
+static xComPortHandle xUart1Port = NULL;
+#endif
+
+#if( ( mainCREATE_COMTEST_BENCHMARK == 1 ) && ( mainCREATE_I2C_BENCHMARK == 1 ) )
+    #error The COM test and I2C benchmarks share the idlecount.c counter, run one at a time
+#endif
+
+#if( configUSE_RPC == 1 )
+
+#if( mainCREATE_COMTEST_BENCHMARK == 1 )
+    #error The RPC server and the COM test benchmark both need UART0
+#endif
+
+/* RPC command IDs, the index of each command in xRpcCommands[]. */
+#define mainRPC_ECHO				( 0 )	/* Returns the request payload. */
+#define mainRPC_GET_TICKS			( 1 )	/* Returns the tick count, two bytes. */
+#define mainRPC_SET_LED				( 2 )	/* LED number, then 0 for off or 1 for on. */
+#define mainRPC_GET_STATUS			( 3 )	/* Returns the latched error flag and the RPC frame error count. */
+
+/*
+ * RPC command handlers, see rpc.h.
+ */
+static uint8_t prvRpcEcho(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength);
+static uint8_t prvRpcGetTicks(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength);
+static uint8_t prvRpcSetLED(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength);
+static uint8_t prvRpcGetStatus(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength);
+
+static code const RpcCommand_t xRpcCommands[] =
+{
+    { prvRpcEcho, 0, rpcMAX_PAYLOAD },      /* mainRPC_ECHO */
+    { prvRpcGetTicks, 0, 0 },               /* mainRPC_GET_TICKS */
+    { prvRpcSetLED, 2, 2 },                 /* mainRPC_SET_LED */
+    { prvRpcGetStatus, 0, 0 }               /* mainRPC_GET_STATUS */
+};
+#endif
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+/*
+ * Cyclic executive slots, see the comments at the top of this file.
+ */
+static void prvCyclicSlotA(void);
+static void prvCyclicSlotB(void);
+
+/* The cyclic schedule, in ascending tick order. */
+code const PortCyclicSlot_t xPortCyclicSchedule[ configPORT_CYCLIC_SLOTS ] =
+{
+    { 0, prvCyclicSlotA },
+    { configPORT_CYCLIC_MAJOR_TICKS / 2, prvCyclicSlotB }
+};
+#endif
+
 /* File scope variable used to communicate the occurrence of an error between
 tasks. */
 static portBASE_TYPE xLatchedError = pdFALSE;
 
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+/* Bytes of the idle stack area never used so far, updated by the check task.
+The address is in the .map file; configPORT_IDLE_STACK_SIZE less this is the
+measured depth of the idle task. */
+UBaseType_t uxIdleStackUnused = 0;
+#endif
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+/* The TCBs and stacks of the tasks defined in this file, and of the idle and
+timer service tasks, placed in XRAM by the linker.  Their addresses can be read
+from the .map file. */
+#if configUSE_PREEMPTION == 1
+static StaticTask_t xRegisterCheckTCB, xFLOPCheck1TCB, xFLOPCheck2TCB;
+static StackType_t uxRegisterCheckStack[ configMINIMAL_STACK_SIZE ];
+static StackType_t uxFLOPCheck1Stack[ configMINIMAL_STACK_SIZE ];
+static StackType_t uxFLOPCheck2Stack[ configMINIMAL_STACK_SIZE ];
+#endif
+static StaticTask_t xErrorChecksTCB;
+static StackType_t uxErrorChecksStack[ configMINIMAL_STACK_SIZE ];
+#if( configPORT_IDLE_ON_NATIVE_STACK == 0 )
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+#endif
+#if( configUSE_TIMERS == 1 )
+static StaticTask_t xTimerTaskTCB;
+static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+#endif
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -172,16 +357,77 @@ void main(void)
     flash tasks. */
     vParTestInitialise();
 
-    /* Start the used standard demo tasks. */
+#if( configSERIAL_USE_UART1 == 1 )
+    xUart1Port = xSerialPortInit(serCOM2, mainUART1_BAUD_RATE, serNO_PARITY, serBITS_8, serSTOP_1, 0);
+#endif
+
+    /* Start the used standard demo tasks.  Each is given a heap ledger owner
+    tag so its queues and semaphores can be identified in the heap report. */
+    portHEAP_LEDGER_OWNER("LED");
+#if( mainCREATE_FLASH_CO_ROUTINES == 1 )
+    vStartFlashCoRoutines(mainNUM_FLASH_CO_ROUTINES);
+    portHEAP_LEDGER_OWNER("HOOK");
+    vStartHookCoRoutines();
+#else
     vStartLEDFlashTasks(mainLED_TASK_PRIORITY);
+#endif
+    portHEAP_LEDGER_OWNER("POLL");
     vStartPolledQueueTasks(mainQUEUE_POLL_PRIORITY);
+    portHEAP_LEDGER_OWNER("INT");
     vStartIntegerMathTasks(mainINTEGER_PRIORITY);
+#if( configUSE_RPC == 1 )
+    /* The host is connected in place of the loopback connector. */
+    portHEAP_LEDGER_OWNER("RPC");
+    vStartRpcTask(mainRPC_PRIORITY, xSerialPortInitMinimal(mainCOM_TEST_BAUD_RATE, 0), xRpcCommands, (uint8_t) (sizeof(xRpcCommands) / sizeof(xRpcCommands[ 0 ])));
+#else
+    portHEAP_LEDGER_OWNER("COM");
     vAltStartComTestTasks(mainCOM_TEST_PRIORITY, mainCOM_TEST_BAUD_RATE, mainCOM_TEST_LED);
+
+    /* The COM test needs Tx looped back to Rx, so check the baud rate by
+    sending the calibration pattern round the loop before the tasks start. */
+    if(xSerialLoopbackTest(NULL) != pdPASS)
+    {
+        xLatchedError = pdTRUE;
+    }
+#endif
+#if( mainCREATE_STATIC_ALLOCATION_TEST == 1 )
+    /* The StaticAllocation.c tasks take the place of the I2C demo, as XRAM
+    will not hold both. */
+    portHEAP_LEDGER_OWNER("STAT");
+    vStartStaticallyAllocatedTasks();
+#elif( configUSE_ACTIVE_OBJECTS == 1 )
+    /* As does the active object benchmark, which also takes the characters
+    received by UART1 straight from the serial interrupt. */
+    portHEAP_LEDGER_OWNER("AO");
+    vStartActiveObjectTest(mainACTIVE_OBJECT_PRIORITY, xUart1Port);
+#else
+    portHEAP_LEDGER_OWNER("I2C");
     vStartI2CTestTasks(mainI2C_TEST_PRIORITY, mainI2C_TEST_LED);
+#endif
+#if( mainCREATE_QUEUE_COPY_BENCHMARK == 1 )
+    portHEAP_LEDGER_OWNER("QCPY");
+    vStartQueueCopyBenchmark(mainQUEUE_COPY_PRIORITY);
+#endif
+#if( configUSE_BINARY_LOG == 1 )
+    portHEAP_LEDGER_OWNER("LOG");
+    vStartBinLogTask(mainBINLOG_PRIORITY, xUart1Port);
+#endif
+    portHEAP_LEDGER_OWNER("MAIN");
     //vStartSemaphoreTasks(mainSEM_TEST_PRIORITY);
 
     /* Start the tasks defined in this file.  The first three never block so
     must not be used with the co-operative scheduler. */
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+#if configUSE_PREEMPTION == 1
+    {
+        xTaskCreateStatic(vRegisterCheck, "RegChck", configMINIMAL_STACK_SIZE, mainDUMMY_POINTER, tskIDLE_PRIORITY, uxRegisterCheckStack, &xRegisterCheckTCB);
+        xTaskCreateStatic(vFLOPCheck1, "FLOP", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, uxFLOPCheck1Stack, &xFLOPCheck1TCB);
+        xTaskCreateStatic(vFLOPCheck2, "FLOP", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, uxFLOPCheck2Stack, &xFLOPCheck2TCB);
+    }
+#endif
+
+    xTaskCreateStatic(vErrorChecks, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, uxErrorChecksStack, &xErrorChecksTCB);
+#else
 #if configUSE_PREEMPTION == 1
     {
         xTaskCreate(vRegisterCheck, "RegChck", configMINIMAL_STACK_SIZE, mainDUMMY_POINTER, tskIDLE_PRIORITY, (TaskHandle_t *) NULL);
@@ -191,6 +437,7 @@ void main(void)
 #endif
 
     xTaskCreate(vErrorChecks, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, (TaskHandle_t *) NULL);
+#endif
 
 
     /* Finally kick off the scheduler.  This function should never return. */
@@ -262,6 +509,9 @@ static void prvToggleOnBoardLED(void)
 static void vErrorChecks(void *pvParameters)
 {
     portBASE_TYPE xErrorHasOccurred = pdFALSE;
+#if( configUSE_HEAP_LEDGER == 1 )
+    portBASE_TYPE xHeapReported = pdFALSE;
+#endif
 
     /* Just to prevent compiler warnings. */
     (void) pvParameters;
@@ -292,30 +542,106 @@ static void vErrorChecks(void *pvParameters)
             xErrorHasOccurred = pdTRUE;
         }
 
+#if( mainCREATE_FLASH_CO_ROUTINES == 1 )
+        if(xAreFlashCoRoutinesStillRunning() != pdTRUE)
+        {
+            xErrorHasOccurred = pdTRUE;
+        }
+
+        if(xAreHookCoRoutinesStillRunning() != pdTRUE)
+        {
+            xErrorHasOccurred = pdTRUE;
+        }
+#endif
+
         if(xArePollingQueuesStillRunning() != pdTRUE)
         {
             xErrorHasOccurred = pdTRUE;
         }
 
+#if( configUSE_RPC == 0 )
         if(xAreComTestTasksStillRunning() != pdTRUE)
         {
             xErrorHasOccurred = pdTRUE;
         }
+#endif
 
+#if( mainCREATE_STATIC_ALLOCATION_TEST == 1 )
+        if(xAreStaticAllocationTasksStillRunning() != pdTRUE)
+        {
+            xErrorHasOccurred = pdTRUE;
+        }
+#elif( configUSE_ACTIVE_OBJECTS == 1 )
+        if(xAreActiveObjectTestsStillRunning() != pdTRUE)
+        {
+            xErrorHasOccurred = pdTRUE;
+        }
+#else
         if(xAreI2CTestTasksStillRunning() != pdTRUE)
         {
             xErrorHasOccurred = pdTRUE;
         }
+#endif
 
         if(xAreSemaphoreTasksStillRunning() != pdTRUE)
         {
             //xErrorHasOccurred = pdTRUE;
         }
 
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+        {
+            PortCyclicStats_t xCyclicStats;
+            UBaseType_t uxSlot;
+
+            for(uxSlot = 0; uxSlot < configPORT_CYCLIC_SLOTS; uxSlot++)
+            {
+                vPortCyclicGetStats(uxSlot, &xCyclicStats);
+                if(xCyclicStats.ucOverruns != 0)
+                {
+                    binlogPRINT2(CYCLIC_OVERRUN, "cyclic slot %hhu overran %hhu times", uxSlot, xCyclicStats.ucOverruns);
+                    xErrorHasOccurred = pdTRUE;
+                }
+            }
+        }
+#endif
+
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+        /* The idle task has used its whole area if none of the fill bytes at
+        the top are left, see configPORT_IDLE_STACK_SIZE. */
+        uxIdleStackUnused = uxPortGetIdleStackHighWaterMark();
+        if(uxIdleStackUnused == 0)
+        {
+            xErrorHasOccurred = pdTRUE;
+        }
+#endif
+
+#if( configUSE_HEAP_LEDGER == 1 )
+        {
+            /* By the end of the first check cycle every task, including the
+            idle task, has been created, so write the XRAM budget once. */
+            if(xHeapReported == pdFALSE)
+            {
+                vPortHeapLedgerReport(prvHeapReportPutChar);
+                xHeapReported = pdTRUE;
+
+#if( configUSE_BINARY_LOG == 0 )
+                if(xUart1Port != NULL)
+                {
+                    uxSerialWrite(xUart1Port, cHeapReport, usHeapReportLength, mainHEAP_REPORT_BLOCK_TIME);
+                }
+#endif
+            }
+        }
+#endif
+
         /* If an error has occurred, latch it to cause the LED flash rate to
         increase. */
         if(xErrorHasOccurred == pdTRUE)
         {
+            if(xLatchedError == pdFALSE)
+            {
+                binlogPRINT1(CHECK_FAILED, "check task: demo error latched at tick %u", xTaskGetTickCount());
+            }
             xLatchedError = pdTRUE;
         }
 
@@ -395,7 +721,7 @@ static void vRegisterCheck(void *pvParameters)
 
     for(;;)
     {
-        if(SP != (configSTACK_START - 1))
+        if(SP != (portTASK_STACK_START - 1))
         {
             mainLATCH_ERROR();
         }
@@ -482,5 +808,144 @@ static void vRegisterCheck(void *pvParameters)
         }
     }
 }
+/*-----------------------------------------------------------*/
+
+#if( configUSE_HEAP_LEDGER == 1 )
+static void prvHeapReportPutChar(char cChar)
+{
+    /* Keep the last byte for the terminating zero. */
+    if(usHeapReportLength < (mainHEAP_REPORT_SIZE - 1))
+    {
+        cHeapReport[ usHeapReportLength++ ] = cChar;
+        cHeapReport[ usHeapReportLength ] = '\0';
+    }
+    else
+    {
+        usHeapReportDropped++;
+    }
+}
+/*-----------------------------------------------------------*/
+#endif
+
+#if( configUSE_RPC == 1 )
+static uint8_t prvRpcEcho(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength)
+{
+    /* Both payloads are in rpc.c's XRAM frame buffers. */
+    vPortXCopy((xdata void *) pucResponse, (const xdata void *) pucRequest, ucRequestLength);
+    *pucResponseLength = ucRequestLength;
+
+    return rpcSTATUS_OK;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvRpcGetTicks(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength)
+{
+    TickType_t xTicks = xTaskGetTickCount();
+
+    (void) pucRequest;
+    (void) ucRequestLength;
+
+    pucResponse[ 0 ] = (uint8_t) xTicks;
+    pucResponse[ 1 ] = (uint8_t) (xTicks >> 8);
+    *pucResponseLength = 2;
+
+    return rpcSTATUS_OK;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvRpcSetLED(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength)
+{
+    (void) ucRequestLength;
+    (void) pucResponse;
+
+    vParTestSetLED(pucRequest[ 0 ], (pucRequest[ 1 ] != 0) ? pdTRUE : pdFALSE);
+    *pucResponseLength = 0;
+
+    return rpcSTATUS_OK;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvRpcGetStatus(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength)
+{
+    uint16_t usErrors = usRpcGetFrameErrors();
+
+    (void) pucRequest;
+    (void) ucRequestLength;
+
+    pucResponse[ 0 ] = (uint8_t) xLatchedError;
+    pucResponse[ 1 ] = (uint8_t) usErrors;
+    pucResponse[ 2 ] = (uint8_t) (usErrors >> 8);
+    *pucResponseLength = 3;
+
+    return rpcSTATUS_OK;
+}
+/*-----------------------------------------------------------*/
+#endif
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+static void prvCyclicSlotA(void)
+{
+    DATAA ^= mainCYCLIC_LED_A;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCyclicSlotB(void)
+{
+    DATAA ^= mainCYCLIC_LED_B;
+}
+/*-----------------------------------------------------------*/
+#endif
+
+#if( configUSE_IDLE_HOOK == 1 )
+/*
+ * The co-routines are scheduled from the idle task, so they only run while no
+ * task of a higher priority is ready, and they run on the idle stack.  The COM
+ * test and I2C benchmarks count the passes of the idle task.
+ */
+void vApplicationIdleHook(void)
+{
+#if( mainCREATE_FLASH_CO_ROUTINES == 1 )
+    vCoRoutineSchedule();
+#endif
+#if( ( mainCREATE_COMTEST_BENCHMARK == 1 ) || ( mainCREATE_I2C_BENCHMARK == 1 ) )
+    vIdleCountHook();
+#endif
+}
+/*-----------------------------------------------------------*/
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+#if( configPORT_IDLE_ON_NATIVE_STACK == 0 )
+
+/*
+ * Supply the memory used by the idle task, which the kernel creates with
+ * xTaskCreateStatic() when static allocation is enabled.  When the idle task
+ * runs on the native IRAM stack port.c supplies it instead.
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, configSTACK_DEPTH_TYPE *puxIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#endif /* configPORT_IDLE_ON_NATIVE_STACK */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMERS == 1 )
+
+/*
+ * Supply the memory used by the timer service task.
+ */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, configSTACK_DEPTH_TYPE *puxTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *puxTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
 
+#endif /* configUSE_TIMERS */
 
+#endif /* configSUPPORT_STATIC_ALLOCATION */
@@ -36,6 +36,11 @@
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "port_mem.h"
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+    #include "port_cyclic.h"
+#endif
 
 /* Constants required to setup timer 2 to produce the RTOS tick. */
 #define portCLOCK_DIVISOR                               ( ( uint32_t ) configCPU_CLOCK_HZ / 32768 )
@@ -54,21 +59,77 @@
 
 /* Used during a context switch to store the size of the stack being copied
 to or from XRAM. */
-data static uint8_t ucStackBytes;
+portHOT_DATA static uint8_t ucStackBytes;
 
 /* Used during a context switch to point to the next byte in XRAM from/to which
 a RAM byte is to be copied. */
-xdata static StackType_t *data pxXRAMStack;
+xdata static StackType_t *portHOT_DATA pxXRAMStack;
 
 /* Used during a context switch to point to the next byte in RAM from/to which
 an XRAM byte is to be copied. */
-data static StackType_t *data pxRAMStack;
+data static StackType_t *portHOT_DATA pxRAMStack;
+
+#if( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+/* Bit n is set while the ready list of priority n is not empty.  See
+portGET_HIGHEST_PRIORITY() in portmacro.h. */
+portHOT_DATA uint8_t ucPortReadyPriorities = 0;
+
+/* The bit of ucPortReadyPriorities used by each priority. */
+code const uint8_t ucPortPriorityBits[ 4 ] = { 0x01, 0x02, 0x04, 0x08 };
+
+/* The index of the highest set bit of each value of ucPortReadyPriorities.
+Entry 0 is never used as the idle task is always ready. */
+code const uint8_t ucPortHighestPriority[ 16 ] =
+{
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+#endif
 
 /* We require the address of the pxCurrentTCB variable, but don't want to know
 any details of its type. */
 typedef void TCB_t;
 extern volatile TCB_t *volatile pxCurrentTCB;
 
+/* Read the XRAM address of the stack of the task in pxCurrentTCB.  The first
+member of the TCB is the generic pxTopOfStack pointer, the low two bytes of
+which are the XRAM address.  TCBs are always in XRAM, so with
+configPORT_USE_XDATA_POINTERS the TCB is read through a two byte xdata
+pointer - two MOVX instructions - instead of through __gptrget. */
+#if( configPORT_USE_XDATA_POINTERS == 1 )
+    #define portTCB_STACK_ADDRESS()     ( *( ( xdata StackType_t * xdata * ) pxCurrentTCB ) )
+#else
+    #define portTCB_STACK_ADDRESS()     ( ( xdata StackType_t * ) *( ( xdata StackType_t ** ) pxCurrentTCB ) )
+#endif
+
+
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+
+/* The idle task memory handed to the kernel by vApplicationGetIdleTaskMemory().
+The XRAM stack is only used to hold the first context of the idle task, which
+xPortStartScheduler() moves to the base of IRAM. */
+static StaticTask_t xPortIdleTCB;
+static StackType_t uxPortIdleStack[ portIDLE_XRAM_STACK_SIZE ];
+
+/* The stack pointer of the idle task while another task is running. */
+portHOT_DATA static uint8_t ucPortIdleSP;
+
+/* The idle stack area above the first idle context is filled with this byte
+when the scheduler starts, so uxPortGetIdleStackHighWaterMark() can find the
+deepest point it has reached. */
+#define portIDLE_STACK_FILL_BYTE        ( 0xa5U )
+
+/* Set to the stack pointer of the idle task if it is ever switched out with
+its context reaching into the task stack area, just before the port halts.
+Kept out of IRAM, the address is in the .map file. */
+volatile uint8_t ucPortIdleOverrunSP = 0;
+
+/* TCBs are always in XRAM, so only the low two bytes of pxCurrentTCB need to
+be compared. */
+#define portCURRENT_TASK_IS_IDLE()      ( ( xdata void * ) pxCurrentTCB == ( xdata void * ) &xPortIdleTCB )
+
+#endif
 
 /*
  * Setup the hardware to generate an interrupt off timer 2 at the required
@@ -87,14 +148,14 @@ static void prvSetupTimerInterrupt(void);
         /* pxCurrentTCB points to a TCB which itself points to the location into            \
         which the first stack byte should be copied. Set pxXRAMStack to point               \
         to the location into which the first stack byte is to be copied. */                 \
-        pxXRAMStack = ( xdata StackType_t * ) *( ( xdata StackType_t ** ) pxCurrentTCB );   \
+        pxXRAMStack = portTCB_STACK_ADDRESS();                                              \
                                                                                             \
         /* Set pxRAMStack to point to the first byte to be coped from the stack. */         \
-        pxRAMStack = ( data StackType_t * data ) configSTACK_START;                         \
+        pxRAMStack = ( data StackType_t * data ) portTASK_STACK_START;                      \
                                                                                             \
         /* Calculate the size of the stack we are about to copy from the current            \
         stack pointer value. */                                                             \
-        ucStackBytes = SP - ( configSTACK_START - 1 );                                      \
+        ucStackBytes = SP - ( portTASK_STACK_START - 1 );                                   \
                                                                                             \
         /* Before starting to copy the stack, store the calculated stack size so            \
         the stack can be restored when the task is resumed. */                              \
@@ -113,15 +174,15 @@ static void prvSetupTimerInterrupt(void);
 /*-----------------------------------------------------------*/
 
 /*
- * Macro that copies the stack of the task being resumed from XRAM into
- * internal RAM.
+ * Macro that copies a stack saved at pxXRAMSource from XRAM into internal RAM
+ * starting at ucStart, then points the stack pointer at it.
  */
-#define portCOPY_XRAM_TO_STACK()                                                            \
+#define portCOPY_XRAM_TO_IRAM( pxXRAMSource, ucStart )                                      \
 {                                                                                           \
         /* Setup the pointers as per portCOPY_STACK_TO_XRAM(), but this time to             \
         copy the data back out of XRAM and into the stack. */                               \
-        pxXRAMStack = ( xdata StackType_t * ) *( ( xdata StackType_t ** ) pxCurrentTCB );   \
-        pxRAMStack = ( data StackType_t * data ) ( configSTACK_START - 1 );                 \
+        pxXRAMStack = ( pxXRAMSource );                                                     \
+        pxRAMStack = ( data StackType_t * data ) ( ( ucStart ) - 1 );                       \
                                                                                             \
         /* The first value stored in XRAM was the size of the stack - i.e. the              \
         number of bytes we need to copy back. */                                            \
@@ -139,6 +200,64 @@ static void prvSetupTimerInterrupt(void);
         /* Restore the stack pointer ready to use the restored stack. */                    \
         SP = ( uint8_t ) pxRAMStack;                                                        \
 }
+
+/*
+ * Macro that copies the stack of the task being resumed from XRAM into
+ * internal RAM.
+ */
+#define portCOPY_XRAM_TO_STACK()    portCOPY_XRAM_TO_IRAM( portTCB_STACK_ADDRESS(), portTASK_STACK_START )
+/*-----------------------------------------------------------*/
+
+/*
+ * Macros that move the stack of the task being switched out to XRAM, and the
+ * stack of the task being switched in back to internal RAM.  The stack of
+ * the idle task never leaves the base of internal RAM, so for it only the
+ * stack pointer is saved and restored.
+ */
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+
+#define portSWITCH_OUT()                                                                    \
+{                                                                                           \
+        if( portCURRENT_TASK_IS_IDLE() )                                                    \
+        {                                                                                   \
+                /* The task stack area above the idle stack is about to be                  \
+                overwritten, so the idle context must not reach into it.  If                \
+                it does the idle task cannot be resumed, so record the stack                \
+                pointer and halt here, interrupts are already disabled by                   \
+                portSAVE_CONTEXT().  This does not depend on configASSERT(). */             \
+                if( SP >= portTASK_STACK_START )                                            \
+                {                                                                           \
+                        ucPortIdleOverrunSP = SP;                                           \
+                        for( ;; )                                                           \
+                        {                                                                   \
+                        }                                                                   \
+                }                                                                           \
+                ucPortIdleSP = SP;                                                          \
+        }                                                                                   \
+        else                                                                                \
+        {                                                                                   \
+                portCOPY_STACK_TO_XRAM();                                                   \
+        }                                                                                   \
+}
+
+#define portSWITCH_IN()                                                                     \
+{                                                                                           \
+        if( portCURRENT_TASK_IS_IDLE() )                                                    \
+        {                                                                                   \
+                SP = ucPortIdleSP;                                                          \
+        }                                                                                   \
+        else                                                                                \
+        {                                                                                   \
+                portCOPY_XRAM_TO_STACK();                                                   \
+        }                                                                                   \
+}
+
+#else
+
+#define portSWITCH_OUT()            portCOPY_STACK_TO_XRAM()
+#define portSWITCH_IN()             portCOPY_XRAM_TO_STACK()
+
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -217,20 +336,29 @@ static void prvSetupTimerInterrupt(void);
 StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters)
 {
     uint32_t ulAddress;
-    StackType_t *pxStartOfStack;
+    portXRAM_POINTER StackType_t *pxStack;
+    portXRAM_POINTER StackType_t *pxStartOfStack;
+
+    /* Stacks are always in XRAM, whether allocated or static, so the generic
+    pointer passed in can be narrowed once and the stack frame then written
+    without going through __gptrput for every byte. */
+#if( configPORT_USE_XDATA_POINTERS == 1 )
+    configASSERT((uint8_t)((uint32_t) pxTopOfStack >> 16) == portXDATA_POINTER_TAG);
+#endif
+    pxStack = (portXRAM_POINTER StackType_t *) pxTopOfStack;
 
     /* Leave space to write the size of the stack as the first byte. */
-    pxStartOfStack = pxTopOfStack;
-    pxTopOfStack++;
+    pxStartOfStack = pxStack;
+    pxStack++;
 
     /* Place a few bytes of known values on the bottom of the stack.
     This is just useful for debugging and can be uncommented if required.
-    *pxTopOfStack = 0x11;
-    pxTopOfStack++;
-    *pxTopOfStack = 0x22;
-    pxTopOfStack++;
-    *pxTopOfStack = 0x33;
-    pxTopOfStack++;
+    *pxStack = 0x11;
+    pxStack++;
+    *pxStack = 0x22;
+    pxStack++;
+    *pxStack = 0x33;
+    pxStack++;
     */
 
     /* Simulate how the stack would look after a call to the scheduler tick
@@ -238,62 +366,62 @@ StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxC
 
     The return address that would have been pushed by the MCU. */
     ulAddress = (uint32_t) pxCode;
-    *pxTopOfStack = (StackType_t) ulAddress;
+    *pxStack = (StackType_t) ulAddress;
     ulAddress >>= 8;
-    pxTopOfStack++;
-    *pxTopOfStack = (StackType_t)(ulAddress);
-    pxTopOfStack++;
+    pxStack++;
+    *pxStack = (StackType_t)(ulAddress);
+    pxStack++;
 
     /* Next all the registers will have been pushed by portSAVE_CONTEXT(). */
-    *pxTopOfStack = 0xaa;        /* acc */
-    pxTopOfStack++;
+    *pxStack = 0xaa;        /* acc */
+    pxStack++;
 
     /* We want tasks to start with interrupts enabled. */
-    *pxTopOfStack = portGLOBAL_INTERRUPT_BIT;
-    pxTopOfStack++;
+    *pxStack = portGLOBAL_INTERRUPT_BIT;
+    pxStack++;
 
     /* The function parameters will be passed in the DPTR and B register as
     a three byte generic pointer is used. */
     ulAddress = (uint32_t) pvParameters;
-    *pxTopOfStack = (StackType_t) ulAddress;          /* DPL */
+    *pxStack = (StackType_t) ulAddress;          /* DPL */
     ulAddress >>= 8;
-    *pxTopOfStack++;
-    *pxTopOfStack = (StackType_t) ulAddress;          /* DPH */
+    pxStack++;
+    *pxStack = (StackType_t) ulAddress;          /* DPH */
     ulAddress >>= 8;
-    pxTopOfStack++;
-    *pxTopOfStack = (StackType_t) ulAddress;          /* b */
-    pxTopOfStack++;
+    pxStack++;
+    *pxStack = (StackType_t) ulAddress;          /* b */
+    pxStack++;
 
     /* The remaining registers are straight forward. */
-    *pxTopOfStack = 0x02;        /* R2 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x03;        /* R3 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x04;        /* R4 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x05;        /* R5 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x06;        /* R6 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x07;        /* R7 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x00;        /* R0 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x01;        /* R1 */
-    pxTopOfStack++;
-    *pxTopOfStack = 0x00;        /* PSW */
-    pxTopOfStack++;
-    *pxTopOfStack = 0xbb;        /* BP */
+    *pxStack = 0x02;        /* R2 */
+    pxStack++;
+    *pxStack = 0x03;        /* R3 */
+    pxStack++;
+    *pxStack = 0x04;        /* R4 */
+    pxStack++;
+    *pxStack = 0x05;        /* R5 */
+    pxStack++;
+    *pxStack = 0x06;        /* R6 */
+    pxStack++;
+    *pxStack = 0x07;        /* R7 */
+    pxStack++;
+    *pxStack = 0x00;        /* R0 */
+    pxStack++;
+    *pxStack = 0x01;        /* R1 */
+    pxStack++;
+    *pxStack = 0x00;        /* PSW */
+    pxStack++;
+    *pxStack = 0xbb;        /* BP */
 
     /* Dont increment the stack size here as we don't want to include
     the stack size byte as part of the stack size count.
 
     Finally we place the stack size at the beginning. */
-    *pxStartOfStack = (StackType_t)(pxTopOfStack - pxStartOfStack);
+    *pxStartOfStack = (StackType_t)(pxStack - pxStartOfStack);
 
     /* Unlike most ports, we return the start of the stack as this is where the
     size of the stack is stored. */
-    return pxStartOfStack;
+    return (StackType_t *) pxStartOfStack;
 }
 /*-----------------------------------------------------------*/
 
@@ -303,6 +431,11 @@ StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxC
 BaseType_t xPortStartScheduler(void)
 {
 
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+    /* Start the slot timer before the first tick can arrive. */
+    vPortCyclicInitialise();
+#endif
+
     /* Setup timer 2 to generate the RTOS tick. */
     prvSetupTimerInterrupt();
 
@@ -310,9 +443,26 @@ BaseType_t xPortStartScheduler(void)
     really be required. */
     SFRPAGE = 0;
 
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+    /* Move the first context of the idle task to the base of the stack, where
+    it stays from now on. */
+    portCOPY_XRAM_TO_IRAM( uxPortIdleStack, configSTACK_START );
+    ucPortIdleSP = SP;
+
+    /* Fill the rest of the idle area for uxPortGetIdleStackHighWaterMark().
+    This function's own frame has just been overwritten, so only the port's
+    static pointer is used. */
+    pxRAMStack = ( data StackType_t * data ) ( ucPortIdleSP + 1 );
+    while( pxRAMStack != ( data StackType_t * data ) portTASK_STACK_START )
+    {
+        *pxRAMStack = portIDLE_STACK_FILL_BYTE;
+        pxRAMStack++;
+    }
+#endif
+
     /* Copy the stack for the first task to execute from XRAM into the stack,
     restore the task context from the new stack, then start running the task. */
-    portCOPY_XRAM_TO_STACK();
+    portSWITCH_IN();
     portRESTORE_CONTEXT();
 
     /* Should never get here! */
@@ -326,6 +476,158 @@ void vPortEndScheduler(void)
 }
 /*-----------------------------------------------------------*/
 
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+
+/*
+ * Supply the memory used by the idle task.  The stack is only large enough
+ * for the first context written by pxPortInitialiseStack(), see portmacro.h.
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, configSTACK_DEPTH_TYPE *puxIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &xPortIdleTCB;
+    *ppxIdleTaskStackBuffer = uxPortIdleStack;
+    *puxIdleTaskStackSize = portIDLE_XRAM_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See portmacro.h.  Only called by tasks other than the idle task, while the
+ * idle area is not in use.
+ */
+UBaseType_t uxPortGetIdleStackHighWaterMark(void)
+{
+    data StackType_t *pxByte;
+    UBaseType_t uxUnused = 0;
+
+    /* Count the untouched fill bytes down from the top of the idle area. */
+    pxByte = ( data StackType_t * ) ( portTASK_STACK_START - 1 );
+    while( ( pxByte > ( data StackType_t * ) ucPortIdleSP ) && ( *pxByte == portIDLE_STACK_FILL_BYTE ) )
+    {
+        uxUnused++;
+        pxByte--;
+    }
+
+    return uxUnused;
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configUSE_PORT_QUEUE_COPY == 1 )
+
+/*
+ * The queue copy routines, see portmacro.h.  Called from ISRs as well as
+ * tasks, which is safe as the port is built with --stack-auto.
+ *
+ * Queue storage is always in XRAM, and so is the item of any task that passes
+ * a static or heap buffer.  When both ends carry the XRAM tag the copy uses
+ * xdata pointers, which compile to MOVX directly instead of a
+ * __gptrget/__gptrput call per byte.  Otherwise one end is elsewhere,
+ * typically an ISR or task local on the IRAM stack, and the 1, 2 and 4 byte
+ * routines still take a single generic access of their width.
+ */
+#define portBOTH_IN_XRAM(pvDest, pvSrc)                                         \
+    ((((uint8_t)((uint32_t) (pvDest) >> 16)) == portXDATA_POINTER_TAG) &&       \
+     (((uint8_t)((uint32_t) (pvSrc) >> 16)) == portXDATA_POINTER_TAG))
+
+static void prvQueueCopy8(void *pvDest, const void *pvSrc, size_t xSize)
+{
+    (void) xSize;
+
+    if(portBOTH_IN_XRAM(pvDest, pvSrc))
+    {
+        *((xdata uint8_t *) pvDest) = *((const xdata uint8_t *) pvSrc);
+    }
+    else
+    {
+        *((uint8_t *) pvDest) = *((const uint8_t *) pvSrc);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueCopy16(void *pvDest, const void *pvSrc, size_t xSize)
+{
+    (void) xSize;
+
+    if(portBOTH_IN_XRAM(pvDest, pvSrc))
+    {
+        *((xdata uint16_t *) pvDest) = *((const xdata uint16_t *) pvSrc);
+    }
+    else
+    {
+        *((uint16_t *) pvDest) = *((const uint16_t *) pvSrc);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueCopy32(void *pvDest, const void *pvSrc, size_t xSize)
+{
+    (void) xSize;
+
+    if(portBOTH_IN_XRAM(pvDest, pvSrc))
+    {
+        *((xdata uint32_t *) pvDest) = *((const xdata uint32_t *) pvSrc);
+    }
+    else
+    {
+        *((uint32_t *) pvDest) = *((const uint32_t *) pvSrc);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueCopyBlock(void *pvDest, const void *pvSrc, size_t xSize)
+{
+    if(portBOTH_IN_XRAM(pvDest, pvSrc))
+    {
+        vPortXCopy((xdata void *) pvDest, (const xdata void *) pvSrc, (uint16_t) xSize);
+    }
+    else
+    {
+        /* The library memcpy(), which this file does not redirect. */
+        memcpy(pvDest, pvSrc, xSize);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Indexed by the value uxPortQueueCopySelect() stores in uxQueueNumber. */
+code const PortQueueCopyFunction_t pxPortQueueCopies[ portQUEUE_COPY_ROUTINES ] =
+{
+    prvQueueCopy8,
+    prvQueueCopy16,
+    prvQueueCopy32,
+    prvQueueCopyBlock
+};
+
+UBaseType_t uxPortQueueCopySelect(UBaseType_t uxItemSize)
+{
+    UBaseType_t uxRoutine;
+
+    switch(uxItemSize)
+    {
+        case sizeof(uint8_t):
+            uxRoutine = 0;
+            break;
+
+        case sizeof(uint16_t):
+            uxRoutine = 1;
+            break;
+
+        case sizeof(uint32_t):
+            uxRoutine = 2;
+            break;
+
+        default:
+            /* Also semaphores and mutexes, whose items are never copied. */
+            uxRoutine = 3;
+            break;
+    }
+
+    return uxRoutine;
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
 /*
  * Manual context switch.  The first thing we do is save the registers so we
  * can use a naked attribute.
@@ -339,14 +641,14 @@ void vPortYield(void) _naked
     PERFORMANCE COULD BE IMPROVED BY ONLY COPYING TO XRAM IF A TASK SWITCH
     IS REQUIRED. */
     portSAVE_CONTEXT();
-    portCOPY_STACK_TO_XRAM();
+    portSWITCH_OUT();
 
     /* Call the standard scheduler context switch function. */
     vTaskSwitchContext();
 
     /* Copy the stack of the task about to execute from XRAM into RAM and
     restore it's context ready to run on exiting. */
-    portCOPY_XRAM_TO_STACK();
+    portSWITCH_IN();
     portRESTORE_CONTEXT();
 }
 /*-----------------------------------------------------------*/
@@ -358,23 +660,42 @@ void vTimer2ISR(void) interrupt(14) _naked
     This does the same as vPortYield() (see above) with the addition
     of incrementing the RTOS tick count. */
     portSAVE_CONTEXT();
-    portCOPY_STACK_TO_XRAM();
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+    /* Run the slots due this tick before the stack copy, which takes a
+    time that depends on the interrupted task.  The flag is cleared first so
+    a slot that runs into the next tick leaves it set, and this interrupt is
+    entered again as soon as it returns. */
+    portCLEAR_INTERRUPT_FLAG();
+    vPortCyclicDispatch();
+#endif
+
+    portSWITCH_OUT();
 
     if(xTaskIncrementTick() != pdFALSE)
     {
         vTaskSwitchContext();
     }
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 0 )
     portCLEAR_INTERRUPT_FLAG();
-    portCOPY_XRAM_TO_STACK();
+#endif
+    portSWITCH_IN();
     portRESTORE_CONTEXT();
 }
 #else
 void vTimer2ISR(void) interrupt(14)
 {
     /* When using the cooperative scheduler the timer 2 ISR is only
-    required to increment the RTOS tick count. */
+    required to increment the RTOS tick count, after running any slots due
+    this tick. */
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+    portCLEAR_INTERRUPT_FLAG();
+    vPortCyclicDispatch();
+    xTaskIncrementTick();
+#else
     xTaskIncrementTick();
     portCLEAR_INTERRUPT_FLAG();
+#endif
 }
 #endif
 /*-----------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+ * Time-triggered cyclic executive.  See port_cyclic.h.
+ *----------------------------------------------------------*/
+
+#include "FreeRTOS.h"
+#include "port_cyclic.h"
+
+#if( configUSE_PORT_CYCLIC_EXECUTIVE == 1 )
+
+#if( ( configPORT_CYCLIC_MAJOR_TICKS < 1 ) || ( configPORT_CYCLIC_MAJOR_TICKS > 255 ) )
+    #error configPORT_CYCLIC_MAJOR_TICKS must be between 1 and 255.
+#endif
+
+/* Timer 0 as a free running 16 bit timer. */
+#define portCYCLIC_TIMER0_MODE_16BIT                    ( ( uint8_t ) 0x01 )
+#define portCYCLIC_TIMER0_MODE_MASK                     ( ( uint8_t ) 0x0f )
+
+/* Set once the next timer 2 interrupt is due.  The flag of the current one
+is cleared by port.c before vPortCyclicDispatch() is called. */
+#define portCYCLIC_TICK_PENDING()                       ( IRCON1 & 0x80 )
+
+/* The tick of the major cycle about to be run, and the first slot of the
+schedule that has not yet run this major cycle. */
+portWARM_DATA static uint8_t ucCyclicTick;
+portWARM_DATA static uint8_t ucCyclicNextSlot;
+
+portCOLD_DATA static PortCyclicStats_t xCyclicStats[ configPORT_CYCLIC_SLOTS ];
+
+/*
+ * Read timer 0 while it runs, retrying if the low byte wrapped between the
+ * two reads.
+ */
+static uint16_t prvReadTimer0(void);
+
+/*-----------------------------------------------------------*/
+
+void vPortCyclicInitialise(void)
+{
+    UBaseType_t uxSlot;
+
+    for(uxSlot = 1; uxSlot < configPORT_CYCLIC_SLOTS; uxSlot++)
+    {
+        configASSERT(xPortCyclicSchedule[ uxSlot ].ucOffset >= xPortCyclicSchedule[ uxSlot - 1 ].ucOffset);
+    }
+
+    ucCyclicTick = 0;
+    ucCyclicNextSlot = 0;
+
+    TR0 = 0;
+    TMOD = (TMOD & ~portCYCLIC_TIMER0_MODE_MASK) | portCYCLIC_TIMER0_MODE_16BIT;
+    TH0 = 0;
+    TL0 = 0;
+    TR0 = 1;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvReadTimer0(void)
+{
+    uint8_t ucHigh, ucLow;
+
+    do
+    {
+        ucHigh = TH0;
+        ucLow = TL0;
+    } while(ucHigh != TH0);
+
+    return ((uint16_t) ucHigh << 8) | ucLow;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCyclicDispatch(void)
+{
+    uint16_t usStart, usTime;
+    portCOLD_DATA PortCyclicStats_t *pxStats;
+
+    while((ucCyclicNextSlot < configPORT_CYCLIC_SLOTS) &&
+          (xPortCyclicSchedule[ ucCyclicNextSlot ].ucOffset == ucCyclicTick))
+    {
+        usStart = prvReadTimer0();
+        xPortCyclicSchedule[ ucCyclicNextSlot ].pxFunction();
+        usTime = prvReadTimer0() - usStart;
+
+        pxStats = &(xCyclicStats[ ucCyclicNextSlot ]);
+        pxStats->usLastTime = usTime;
+        if(usTime > pxStats->usMaxTime)
+        {
+            pxStats->usMaxTime = usTime;
+        }
+
+        /* The slot, together with the ones before it this tick, ran into
+        the next tick. */
+        if(portCYCLIC_TICK_PENDING() && (pxStats->ucOverruns != 0xff))
+        {
+            pxStats->ucOverruns++;
+        }
+
+        ucCyclicNextSlot++;
+    }
+
+    if(++ucCyclicTick >= configPORT_CYCLIC_MAJOR_TICKS)
+    {
+        ucCyclicTick = 0;
+        ucCyclicNextSlot = 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPortCyclicGetStats(UBaseType_t uxSlot, PortCyclicStats_t *pxStats)
+{
+    configASSERT(uxSlot < configPORT_CYCLIC_SLOTS);
+
+    /* The record is updated from the tick interrupt. */
+    portENTER_CRITICAL();
+    {
+        *pxStats = xCyclicStats[ uxSlot ];
+    }
+    portEXIT_CRITICAL();
+}
+
+#endif /* configUSE_PORT_CYCLIC_EXECUTIVE */
@@ -0,0 +1,80 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PORT_CYCLIC_H
+#define PORT_CYCLIC_H
+
+/*
+ * Time-triggered cyclic executive run from the timer 2 tick interrupt.
+ *
+ * The application defines xPortCyclicSchedule[] in code memory, listing
+ * configPORT_CYCLIC_SLOTS slots in ascending ucOffset order.  On tick n of
+ * every configPORT_CYCLIC_MAJOR_TICKS tick major cycle the tick interrupt
+ * calls the function of each slot whose ucOffset is n.  The slots run right
+ * after the registers are saved and before the stack is copied to XRAM or
+ * the kernel tick is processed, so their start time does not depend on the
+ * task that was interrupted.  What remains is the interrupt latency, which
+ * is bounded by the longest critical section.
+ *
+ * Slot functions run with interrupts disabled, on the stack of the
+ * interrupted task, so they:
+ *  - must not call the FreeRTOS API,
+ *  - must be short, as every other interrupt waits for them,
+ *  - add their stack depth to that of every task, and of the idle area when
+ *    configPORT_IDLE_ON_NATIVE_STACK is set.
+ *
+ * Timer 0 runs free in 16 bit mode to time each slot.  A slot overruns when
+ * the next tick interrupt is already pending as it returns, in which case
+ * the kernel tick is handled late but not lost.
+ */
+
+typedef struct xPORT_CYCLIC_SLOT
+{
+    uint8_t ucOffset;                   /* Tick of the major cycle to run on. */
+    void (*pxFunction)(void);
+} PortCyclicSlot_t;
+
+/* Execution record of a single slot, as returned by vPortCyclicGetStats(). */
+typedef struct xPORT_CYCLIC_STATS
+{
+    uint16_t usLastTime;                /* Timer 0 counts taken by the last run. */
+    uint16_t usMaxTime;                 /* Longest run so far. */
+    uint8_t ucOverruns;                 /* Runs that ended after the next tick was due. */
+} PortCyclicStats_t;
+
+/* Supplied by the application. */
+extern code const PortCyclicSlot_t xPortCyclicSchedule[ configPORT_CYCLIC_SLOTS ];
+
+/* Called by port.c. */
+void vPortCyclicInitialise(void);
+void vPortCyclicDispatch(void);
+
+/* Fill *pxStats with the record of slot uxSlot (0 to configPORT_CYCLIC_SLOTS - 1). */
+void vPortCyclicGetStats(UBaseType_t uxSlot, PortCyclicStats_t *pxStats);
+
+#endif /* PORT_CYCLIC_H */
@@ -0,0 +1,166 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*-----------------------------------------------------------
+ * Assembler block copy and fill routines.  See port_mem.h.
+ *
+ * The port is built with --stack-auto, so every routine follows the SDCC
+ * reentrant calling convention: the first parameter is passed in DPL/DPH,
+ * the others are pushed on the stack from right to left, low byte first,
+ * and removed again by the caller.  On entry SP therefore points at the
+ * high byte of the return address, with the second parameter directly
+ * below it.  R0-R7, A, B and DPTR may all be used freely, and an 8 bit
+ * result is returned in DPL.
+ *-----------------------------------------------------------*/
+
+#include "FreeRTOS.h"
+#include "port_mem.h"
+
+/*-----------------------------------------------------------*/
+
+void vPortXCopy(xdata void *pvDest, const xdata void *pvSrc, uint16_t usBytes) _naked
+{
+    (void) pvDest;
+    (void) pvSrc;
+    (void) usBytes;
+
+    _asm
+        /* R5:R4 = pvDest, R3:R2 = pvSrc, R7:R6 = usBytes. */
+        mov     r4,dpl
+        mov     r5,dph
+        mov     a,sp
+        add     a,#0xfe
+        mov     r0,a
+        mov     a,@r0
+        mov     r3,a
+        dec     r0
+        mov     a,@r0
+        mov     r2,a
+        dec     r0
+        mov     a,@r0
+        mov     r7,a
+        dec     r0
+        mov     a,@r0
+        mov     r6,a
+        orl     a,r7
+        jz      00090$
+
+        /* Two nested DJNZ loops count 16 bits, so the outer count is one more
+        than the high byte unless the low byte is zero. */
+        mov     a,r6
+        jz      00010$
+        inc     r7
+    00010$:
+        mov     dpl,r2
+        mov     dph,r3
+        movx    a,@dptr
+        inc     dptr
+        mov     r2,dpl
+        mov     r3,dph
+        mov     dpl,r4
+        mov     dph,r5
+        movx    @dptr,a
+        inc     dptr
+        mov     r4,dpl
+        mov     r5,dph
+        djnz    r6,00010$
+        djnz    r7,00010$
+    00090$:
+        ret
+    _endasm;
+}
+/*-----------------------------------------------------------*/
+
+void vPortIRAMCopyFromX(idata void *pvDest, const xdata void *pvSrc, uint8_t ucBytes) _naked
+{
+    (void) pvDest;
+    (void) pvSrc;
+    (void) ucBytes;
+
+    _asm
+        /* R1 = pvDest, DPTR = pvSrc, R6 = ucBytes. */
+        mov     r1,dpl
+        mov     a,sp
+        add     a,#0xfe
+        mov     r0,a
+        mov     dph,@r0
+        dec     r0
+        mov     dpl,@r0
+        dec     r0
+        mov     a,@r0
+        jz      00090$
+        mov     r6,a
+    00010$:
+        movx    a,@dptr
+        mov     @r1,a
+        inc     dptr
+        inc     r1
+        djnz    r6,00010$
+    00090$:
+        ret
+    _endasm;
+}
+/*-----------------------------------------------------------*/
+
+void vPortXFill(xdata void *pvDest, uint8_t ucValue, uint16_t usBytes) _naked
+{
+    (void) pvDest;
+    (void) ucValue;
+    (void) usBytes;
+
+    _asm
+        /* DPTR = pvDest, R2 = ucValue, R7:R6 = usBytes. */
+        mov     a,sp
+        add     a,#0xfe
+        mov     r0,a
+        mov     a,@r0
+        mov     r2,a
+        dec     r0
+        mov     a,@r0
+        mov     r7,a
+        dec     r0
+        mov     a,@r0
+        mov     r6,a
+        orl     a,r7
+        jz      00090$
+
+        mov     a,r6
+        jz      00005$
+        inc     r7
+    00005$:
+        mov     a,r2
+    00010$:
+        movx    @dptr,a
+        inc     dptr
+        djnz    r6,00010$
+        djnz    r7,00010$
+    00090$:
+        ret
+    _endasm;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,58 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef PORT_MEM_H
+#define PORT_MEM_H
+
+/*
+ * Block copy and fill routines for the 8051 memory spaces, written in
+ * assembler in port_mem.c.  Each routine takes pointers of the exact memory
+ * space it works on, so no generic pointer tag is tested per byte as the
+ * library memcpy() and memset() do.  Zero lengths are allowed.
+ *
+ * Estimated machine cycles per byte, loop only.  These are counted by hand
+ * from the instruction timings of the standard 12 clock 8051 and have not
+ * been measured on the BF7615:
+ *
+ *  vPortXCopy()            xdata -> xdata      26
+ *  vPortIRAMCopyFromX()    xdata -> idata       8
+ *  vPortXFill()            xdata                6
+ *
+ * The BF7615 has a single DPTR, so the two XRAM pointers of vPortXCopy() are
+ * swapped through R2-R5 on every byte.
+ *
+ * vPortXCopy() is used by the port's queue copy and heap ledger and by the
+ * RPC echo command in main.c, vPortIRAMCopyFromX() by the heap ledger report
+ * and vPortXFill() by the serial driver to clear its counters.
+ */
+
+void vPortXCopy(xdata void *pvDest, const xdata void *pvSrc, uint16_t usBytes) _naked;
+void vPortIRAMCopyFromX(idata void *pvDest, const xdata void *pvSrc, uint8_t ucBytes) _naked;
+void vPortXFill(xdata void *pvDest, uint8_t ucValue, uint16_t usBytes) _naked;
+
+#endif /* PORT_MEM_H */
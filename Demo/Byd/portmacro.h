@@ -37,8 +37,22 @@ void vTimer2ISR(void) interrupt(14) _naked;
 
 void vSerialISR(void) interrupt(17);
 
+#if( configSERIAL_USE_UART1 == 1 )
+void vSerial1ISR(void) interrupt(18);
+#endif
+
 void vI2CISR(void) interrupt(10);
 
+/* Timer 1, vector 3, serves either the serial driver's gap timer or the
+timer driven I2C master, see the #error in i2c_master_timer.c. */
+#if( ( configSERIAL_USE_FRAME_MODE == 1 ) || ( configSERIAL_USE_RX_BUFFERS == 1 ) )
+void vSerialFrameTimerISR(void) interrupt(3);
+#endif
+
+#if( configI2C_MASTER_USE_TIMER == 1 )
+void vI2CMasterTimerISR(void) interrupt(3);
+#endif
+
 /*-----------------------------------------------------------
  * Port specific definitions.
  *
@@ -91,12 +105,201 @@ typedef uint32_t TickType_t;
 #define portENABLE_INTERRUPTS()		EA = 1;
 /*-----------------------------------------------------------*/
 
+/* Memory space placement.  With --model-large a variable without a storage
+class lands in XRAM, where every access is a MOV DPTR,#addr / MOVX pair.  Port
+and driver variables are instead tagged with one of three classes, each of
+which can be redirected from FreeRTOSConfig.h:
+
+portHOT_DATA - scalars used on every context switch or interrupt.  Direct
+addressed internal RAM (MOV A,dir - 2 bytes).  Every byte placed here moves
+configSTACK_START up and so shrinks the task stacks.
+
+portWARM_DATA - interrupt and allocator state.  The 256 byte pdata page,
+reached with MOV R0,#addr / MOVX A,@R0 (3 bytes) while P2_XH holds the page
+set up by the C start up code, so P2_XH must not be written by the
+application.
+
+portCOLD_DATA - everything else, left in XRAM (4 bytes per access).
+
+Variables that are declared extern in another file must carry the same class
+in the extern declaration.
+
+The kernel's own variables are not covered.  pxCurrentTCB, xTickCount and the
+ready and delayed lists are defined in tasks.c, which is not part of this
+tree, and the kernel has no hook that could give them a storage class: its
+PRIVILEGED_DATA only exists with the MPU wrappers, and a leading SDCC space
+qualifier on a pointer declaration applies to the pointee, not the pointer.
+They stay in XRAM.  The one hot kernel item the port can take over is the
+ready priority bitmap, which configUSE_PORT_OPTIMISED_TASK_SELECTION keeps in
+portHOT_DATA, see below. */
+#ifndef configPORT_HOT_DATA
+	#define configPORT_HOT_DATA		data
+#endif
+
+#ifndef configPORT_WARM_DATA
+	#define configPORT_WARM_DATA	pdata
+#endif
+
+#define portHOT_DATA				configPORT_HOT_DATA
+#define portWARM_DATA				configPORT_WARM_DATA
+#define portCOLD_DATA				xdata
+/*-----------------------------------------------------------*/
+
+/* Pointer width.  An unqualified SDCC pointer is a three byte generic pointer
+and every access through it is a call to __gptrget or __gptrput.  TCBs, stacks
+and queue storage are always in XRAM, so with configPORT_USE_XDATA_POINTERS set
+to 1 the port reaches them through two byte xdata pointers, using MOVX @DPTR
+directly.  That covers the context switch copy, the initial stack frame and,
+through the queue copy routines below, the queue storage side of every item
+copy.  The kernel itself is not covered: tasks.c, list.c and queue.c are not
+part of this tree, so vTaskSwitchContext(), the list traversal and the rest
+of xQueueGenericSend() still use generic pointers. */
+#ifndef configPORT_USE_XDATA_POINTERS
+	#define configPORT_USE_XDATA_POINTERS	1
+#endif
+
+#if( configPORT_USE_XDATA_POINTERS == 1 )
+	#define portXRAM_POINTER		xdata
+#else
+	#define portXRAM_POINTER
+#endif
+
+/* Tag byte SDCC stores in the top byte of a generic pointer to XRAM. */
+#define portXDATA_POINTER_TAG		( 0x00 )
+/*-----------------------------------------------------------*/
+
+/* Idle task on the native IRAM stack.  With configPORT_IDLE_ON_NATIVE_STACK
+set to 1 the bottom configPORT_IDLE_STACK_SIZE bytes of the IRAM stack belong
+to the idle task and are never copied.  All other tasks run above them from
+portTASK_STACK_START, so a switch into the idle task only saves the outgoing
+task and a switch out of it only restores the incoming one.  The idle context,
+plus any interrupt taken while it runs, must fit in configPORT_IDLE_STACK_SIZE.
+port.c halts, with the stack pointer in ucPortIdleOverrunSP, if the idle task
+is ever switched out with a deeper context, and
+uxPortGetIdleStackHighWaterMark() reports how close it has come.
+
+port.c supplies the idle task memory through vApplicationGetIdleTaskMemory().
+Its XRAM stack only holds the first context written by pxPortInitialiseStack():
+the size byte, the return address and the 15 registers. */
+#ifndef configPORT_IDLE_ON_NATIVE_STACK
+	#define configPORT_IDLE_ON_NATIVE_STACK	0
+#endif
+
+#ifndef configPORT_IDLE_STACK_SIZE
+	#define configPORT_IDLE_STACK_SIZE	( 0 )
+#endif
+
+#if( configPORT_IDLE_ON_NATIVE_STACK == 1 )
+
+	#if( configSUPPORT_STATIC_ALLOCATION != 1 )
+		#error configPORT_IDLE_ON_NATIVE_STACK requires configSUPPORT_STATIC_ALLOCATION to be set to 1.
+	#endif
+
+	#if( configPORT_IDLE_STACK_SIZE < 0x20 )
+		#error configPORT_IDLE_STACK_SIZE is too small to hold the idle task context.
+	#endif
+
+	#define portIDLE_XRAM_STACK_SIZE	( 18 )
+
+	/* The number of bytes at the top of the idle area that the idle task, and
+	the interrupts and context switches taken on its stack, have never used.
+	0 means the area is too small, see configPORT_IDLE_STACK_SIZE. */
+	UBaseType_t uxPortGetIdleStackHighWaterMark( void );
+
+#endif /* configPORT_IDLE_ON_NATIVE_STACK */
+
+/* The first IRAM byte of the stack of every task that is copied to XRAM. */
+#define portTASK_STACK_START		( configSTACK_START + configPORT_IDLE_STACK_SIZE )
+/*-----------------------------------------------------------*/
+
 /* Hardware specifics. */
 #define portBYTE_ALIGNMENT			1
 #define portSTACK_GROWTH			( 1 )
 #define portTICK_PERIOD_MS			( ( uint32_t ) 1000 / configTICK_RATE_HZ )
 /*-----------------------------------------------------------*/
 
+/* Port optimised task selection.  The kernel's uxTopReadyPriority is an XRAM
+variable, so the ready bitmap is kept by the port in a single byte of internal
+RAM instead and the uxReadyPriorities argument of the macros below is not used.
+Setting and clearing a bit is one table lookup in place of a variable shift
+loop, and the highest set bit is found with one MOVC from a 16 entry code
+table, so selecting the next task costs the same whatever is ready. */
+#if( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+	#if( configMAX_PRIORITIES > 4 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be used when configMAX_PRIORITIES is less than or equal to 4.
+	#endif
+
+	extern portHOT_DATA uint8_t ucPortReadyPriorities;
+	extern code const uint8_t ucPortPriorityBits[ 4 ];
+	extern code const uint8_t ucPortHighestPriority[ 16 ];
+
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )	ucPortReadyPriorities |= ucPortPriorityBits[ ( uxPriority ) ]
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )	ucPortReadyPriorities &= ( uint8_t ) ~ucPortPriorityBits[ ( uxPriority ) ]
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )	uxTopPriority = ucPortHighestPriority[ ucPortReadyPriorities ]
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+/* Queue item copy.  queue.c copies every item with memcpy(), which the SDCC
+library implements as a byte loop over generic pointers, and the queues used
+by the drivers carry one byte per item.  The port instead has a copy routine
+for each of 1, 2 and 4 byte items, which move the item with a single access of
+that width, and one for any other size.  All of them copy through xdata
+pointers when both ends are in XRAM.
+
+The routine is chosen once, when the queue is created: traceQUEUE_CREATE(), in
+FreeRTOSConfig.h, stores the index uxPortQueueCopySelect() returns for the
+item size in the queue's uxQueueNumber.  That field only exists with
+configUSE_TRACE_FACILITY set, and is then the port's, so vQueueSetQueueNumber()
+must not be used.  In queue.c alone memcpy() is routed through
+pxPortQueueCopies[], indexed by pxQueue->uxQueueNumber: every memcpy() in
+queue.c is in prvCopyDataToQueue() or prvCopyDataFromQueue(), whose queue
+parameter is pxQueue.  CMakeLists.txt defines portQUEUE_COPY_FILE for queue.c
+only, so the library memcpy() is untouched everywhere else.  <string.h> is
+included first so the macro does not touch its prototype.
+Demo/Common/Minimal/qcopytest.c measures it. */
+#if( configUSE_PORT_QUEUE_COPY == 1 )
+	#if( configUSE_TRACE_FACILITY == 0 )
+		#error configUSE_PORT_QUEUE_COPY keeps the copy routine in uxQueueNumber, so needs configUSE_TRACE_FACILITY
+	#endif
+
+	#define portQUEUE_COPY_ROUTINES		4
+
+	typedef void ( *PortQueueCopyFunction_t )( void *pvDest, const void *pvSrc, size_t xSize );
+
+	extern code const PortQueueCopyFunction_t pxPortQueueCopies[ portQUEUE_COPY_ROUTINES ];
+	UBaseType_t uxPortQueueCopySelect( UBaseType_t uxItemSize );
+
+	#ifdef portQUEUE_COPY_FILE
+		#include <string.h>
+		#define memcpy( pvDest, pvSrc, xSize )	pxPortQueueCopies[ pxQueue->uxQueueNumber ]( ( pvDest ), ( pvSrc ), ( xSize ) )
+	#endif
+#endif
+/*-----------------------------------------------------------*/
+
+/* Selective reentrancy.  Every source file is built with --stack-auto except
+those listed in PORT_SINGLE_CONTEXT_SOURCES in CMakeLists.txt.  The helpers in
+those files are marked portSINGLE_CONTEXT: they are only ever run by one task,
+so their parameters and locals live in static XRAM frames instead of on the
+IRAM stack that is copied on every context switch.  Entry points of such a
+file that are called from the rest of the build must be marked portREENTRANT
+so they keep the --stack-auto calling convention.
+
+A single-context file must not call any FreeRTOS API function that takes two
+or more parameters.  Without --stack-auto SDCC passes every parameter after
+the first through _PARM_n statics, which the kernel, built with --stack-auto,
+never reads.  Nor may it hold an interrupt routine, whose static locals would
+be shared with the code it interrupts.  portSINGLE_CONTEXT itself expands to
+nothing and checks nothing; CMakeLists.txt enforces the rule instead, more
+strictly, by refusing to configure when a listed file calls the kernel at
+all.  The SDCC helpers behind int, long and float arithmetic are called with
+the reentrant convention from every file, as long as --int-long-reent and
+--float-reent stay in the build flags, which CMakeLists.txt also checks. */
+#define portREENTRANT			reentrant
+#define portSINGLE_CONTEXT
+/*-----------------------------------------------------------*/
+
 /* Task utilities. */
 void vPortYield(void) _naked;
 #define portYIELD()	vPortYield();
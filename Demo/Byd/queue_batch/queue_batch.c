@@ -0,0 +1,184 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+
+
+/* BATCH SEND AND RECEIVE ON TOP OF THE STANDARD QUEUE API.
+
+The items already in a queue are moved with the scheduler suspended, so the
+receiving task is not preempted part way through a batch and a task that is
+unblocked by the batch only runs once, when the scheduler is resumed.
+Interrupts stay enabled throughout so the serial and I2C ISRs are not
+delayed. */
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#include "queue_batch.h"
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultiple(QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxItems, UBaseType_t uxMinItems, TickType_t xTicksToWait)
+{
+    uint8_t *pucBuffer = (uint8_t *) pvBuffer;
+    UBaseType_t uxItemSize, uxReceived = 0;
+    TimeOut_t xTimeOut;
+
+    configASSERT(uxMinItems <= uxMaxItems);
+
+    uxItemSize = uxQueueGetQueueItemSize(xQueue);
+    vTaskSetTimeOutState(&xTimeOut);
+
+    for(;;)
+    {
+        /* Take everything that is already queued, up to uxMaxItems. */
+        vTaskSuspendAll();
+        {
+            while((uxReceived < uxMaxItems) && (xQueueReceive(xQueue, pucBuffer, 0) == pdPASS))
+            {
+                pucBuffer += uxItemSize;
+                uxReceived++;
+            }
+        }
+        (void) xTaskResumeAll();
+
+        if(uxReceived >= uxMinItems)
+        {
+            break;
+        }
+
+        /* Not enough yet - block for the next item, then go back round to
+        collect any that arrived with it. */
+        if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+            break;
+        }
+
+        if(xQueueReceive(xQueue, pucBuffer, xTicksToWait) != pdPASS)
+        {
+            break;
+        }
+
+        pucBuffer += uxItemSize;
+        uxReceived++;
+    }
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueSendMultiple(QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxItems, TickType_t xTicksToWait)
+{
+    const uint8_t *pucItems = (const uint8_t *) pvItems;
+    UBaseType_t uxItemSize, uxSent = 0;
+    TimeOut_t xTimeOut;
+
+    uxItemSize = uxQueueGetQueueItemSize(xQueue);
+    vTaskSetTimeOutState(&xTimeOut);
+
+    for(;;)
+    {
+        /* Fill whatever space is free. */
+        vTaskSuspendAll();
+        {
+            while((uxSent < uxItems) && (xQueueSend(xQueue, pucItems, 0) == pdPASS))
+            {
+                pucItems += uxItemSize;
+                uxSent++;
+            }
+        }
+        (void) xTaskResumeAll();
+
+        if(uxSent >= uxItems)
+        {
+            break;
+        }
+
+        /* The queue is full - block until there is space for the next item. */
+        if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+            break;
+        }
+
+        if(xQueueSend(xQueue, pucItems, xTicksToWait) != pdPASS)
+        {
+            break;
+        }
+
+        pucItems += uxItemSize;
+        uxSent++;
+    }
+
+    return uxSent;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultipleFromISR(QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxItems, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint8_t *pucBuffer = (uint8_t *) pvBuffer;
+    UBaseType_t uxItemSize, uxReceived = 0;
+    BaseType_t xTaskWoken = pdFALSE;
+
+    uxItemSize = uxQueueGetQueueItemSize(xQueue);
+
+    while((uxReceived < uxMaxItems) && (xQueueReceiveFromISR(xQueue, pucBuffer, &xTaskWoken) == pdPASS))
+    {
+        pucBuffer += uxItemSize;
+        uxReceived++;
+    }
+
+    if((xTaskWoken != pdFALSE) && (pxHigherPriorityTaskWoken != NULL))
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueSendMultipleFromISR(QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxItems, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    const uint8_t *pucItems = (const uint8_t *) pvItems;
+    UBaseType_t uxItemSize, uxSent = 0;
+    BaseType_t xTaskWoken = pdFALSE;
+
+    uxItemSize = uxQueueGetQueueItemSize(xQueue);
+
+    while((uxSent < uxItems) && (xQueueSendFromISR(xQueue, pucItems, &xTaskWoken) == pdPASS))
+    {
+        pucItems += uxItemSize;
+        uxSent++;
+    }
+
+    if((xTaskWoken != pdFALSE) && (pxHigherPriorityTaskWoken != NULL))
+    {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+
+    return uxSent;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,331 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+/* BINARY RPC SERVER.
+
+Encoded bytes are read from the serial driver straight into ucRpcRxFrame.
+When the zero that ends a frame arrives the frame is COBS decoded where it
+lies, which moves the data along by one byte and needs no second buffer, and
+its handler is given a pointer into it.  The handler writes its response into
+ucRpcTxFrame one byte in from the start, which is then encoded in place and
+handed to the serial driver as a Tx descriptor, so the response is not copied
+either.  The next request is decoded and checked while the response goes out,
+and only waits for the Tx frame to be free before its handler runs.
+
+Frames are never longer than configRPC_FRAME_SIZE, well below the 254 bytes at
+which COBS needs a code byte that is not followed by a zero, so the in place
+encoding and decoding do not have to allow for one. */
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "serial.h"
+#include "rpc.h"
+
+#if( configUSE_RPC == 1 )
+
+#define rpcSTACK_SIZE           configMINIMAL_STACK_SIZE
+
+/* A frame gains one byte when encoded, and is followed by the zero. */
+#define rpcENCODED_SIZE         (configRPC_FRAME_SIZE + 1)
+#define rpcRX_BUFFER_SIZE       (rpcENCODED_SIZE + 1)
+#define rpcTX_BUFFER_SIZE       (rpcENCODED_SIZE + 1)
+
+#define rpcCRC_INITIAL          ((uint16_t) 0xffff)
+
+/* CRC16 CCITT (polynomial 0x1021) of every byte value. */
+static code const uint16_t usRpcCRCTable[ 256 ] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+    0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+    0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+    0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+    0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+    0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+    0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+    0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+    0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+    0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+    0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+    0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+    0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+    0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+    0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+    0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+    0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+    0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+    0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+    0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+    0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+    0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
+};
+
+/* Encoded bytes received since the last zero. */
+portCOLD_DATA static uint8_t ucRpcRxFrame[ rpcRX_BUFFER_SIZE ];
+
+/* The response being built or sent: the COBS code byte, then the sequence
+number, status, payload and CRC, then the zero. */
+portCOLD_DATA static uint8_t ucRpcTxFrame[ rpcTX_BUFFER_SIZE ];
+
+static xComPortHandle xRpcPort = NULL;
+static code const RpcCommand_t *pxRpcCommands = NULL;
+static uint8_t ucRpcCommands = 0;
+static volatile uint16_t usRpcFrameErrors = 0;
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    static StaticTask_t xRpcTaskTCB;
+    static StackType_t uxRpcTaskStack[ rpcSTACK_SIZE ];
+#endif
+
+static portTASK_FUNCTION_PROTO(vRpcTask, pvParameters);
+
+/*
+ * Check and answer the request in the ucLength encoded bytes at pucFrame.
+ */
+static void prvRpcHandleFrame(uint8_t *pucFrame, uint8_t ucLength);
+
+/*
+ * Decode the ucLength bytes of COBS at pucFrame in place.  The decoded bytes
+ * start at pucFrame + 1.  Returns their number, or 0 if the encoding is bad.
+ */
+static uint8_t prvCOBSDecode(uint8_t *pucFrame, uint8_t ucLength);
+
+/*
+ * Encode the ucLength bytes at pucFrame + 1 in place, so the encoded frame
+ * starts at pucFrame, and add the zero that ends it.  Returns the number of
+ * bytes to send.
+ */
+static uint8_t prvCOBSEncode(uint8_t *pucFrame, uint8_t ucLength);
+
+/*-----------------------------------------------------------*/
+
+void vStartRpcTask(UBaseType_t uxPriority, xComPortHandle pxPort, code const RpcCommand_t *pxCommands, uint8_t ucCommands)
+{
+    xRpcPort = pxPort;
+    pxRpcCommands = pxCommands;
+    ucRpcCommands = ucCommands;
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    xTaskCreateStatic(vRpcTask, "RPC", rpcSTACK_SIZE, NULL, uxPriority, uxRpcTaskStack, &xRpcTaskTCB);
+#else
+    xTaskCreate(vRpcTask, "RPC", rpcSTACK_SIZE, NULL, uxPriority, NULL);
+#endif
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usRpcGetFrameErrors(void)
+{
+    return usRpcFrameErrors;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usRpcCRC16(uint16_t usCRC, const uint8_t *pucData, uint8_t ucLength)
+{
+    while(ucLength-- != 0)
+    {
+        usCRC = (usCRC << 8) ^ usRpcCRCTable[ (uint8_t) (usCRC >> 8) ^ *pucData++ ];
+    }
+
+    return usCRC;
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION(vRpcTask, pvParameters)
+{
+    uint8_t ucLength = 0, ucScan, ucEnd;
+    portBASE_TYPE xDiscarding = pdFALSE;
+
+    /* Just to prevent compiler warnings. */
+    (void) pvParameters;
+
+    for(;;)
+    {
+        if(ucLength == rpcRX_BUFFER_SIZE)
+        {
+            /* Too long to be a frame.  Throw it away up to the next zero. */
+            usRpcFrameErrors++;
+            ucLength = 0;
+            xDiscarding = pdTRUE;
+        }
+
+        ucScan = ucLength;
+        ucLength += (uint8_t) uxSerialRead(xRpcPort, &ucRpcRxFrame[ ucLength ], rpcRX_BUFFER_SIZE - ucLength, portMAX_DELAY);
+
+        /* There may be more than one frame in what was read, if the host has
+        several requests in flight. */
+        for(ucEnd = ucScan; ucEnd < ucLength; ucEnd++)
+        {
+            if(ucRpcRxFrame[ ucEnd ] != 0)
+            {
+                continue;
+            }
+
+            /* An empty frame is just a zero the host sent to resynchronise. */
+            if((xDiscarding == pdFALSE) && (ucEnd != 0))
+            {
+                prvRpcHandleFrame(ucRpcRxFrame, ucEnd);
+            }
+            xDiscarding = pdFALSE;
+
+            /* Move the start of the next frame to the front. */
+            ucEnd++;
+            ucLength -= ucEnd;
+            memmove(ucRpcRxFrame, &ucRpcRxFrame[ ucEnd ], ucLength);
+            ucEnd = (uint8_t) -1;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRpcHandleFrame(uint8_t *pucFrame, uint8_t ucLength)
+{
+    code const RpcCommand_t *pxCommand;
+    uint8_t *pucData;
+    uint8_t ucCommand, ucPayloadLength, ucResponseLength, ucStatus;
+    uint16_t usCRC;
+
+    ucLength = prvCOBSDecode(pucFrame, ucLength);
+    pucData = pucFrame + 1;
+
+    if(ucLength < rpcFRAME_OVERHEAD)
+    {
+        usRpcFrameErrors++;
+        return;
+    }
+
+    usCRC = usRpcCRC16(rpcCRC_INITIAL, pucData, ucLength - 2);
+    if((pucData[ ucLength - 2 ] != (uint8_t) usCRC) || (pucData[ ucLength - 1 ] != (uint8_t) (usCRC >> 8)))
+    {
+        usRpcFrameErrors++;
+        return;
+    }
+
+    ucCommand = pucData[ 1 ];
+    ucPayloadLength = ucLength - rpcFRAME_OVERHEAD;
+
+    /* The previous response must be on its way before this one can be
+    written over it. */
+    while(xSerialWaitForDescriptor(xRpcPort, portMAX_DELAY) == pdFALSE)
+    {
+    }
+
+    ucResponseLength = 0;
+
+    if((ucCommand >= ucRpcCommands) || (pxRpcCommands[ ucCommand ].pxHandler == NULL))
+    {
+        ucStatus = rpcSTATUS_UNKNOWN_COMMAND;
+    }
+    else
+    {
+        pxCommand = &pxRpcCommands[ ucCommand ];
+
+        if((ucPayloadLength < pxCommand->ucMinLength) || (ucPayloadLength > pxCommand->ucMaxLength))
+        {
+            ucStatus = rpcSTATUS_BAD_LENGTH;
+        }
+        else
+        {
+            ucStatus = pxCommand->pxHandler(&pucData[ 2 ], ucPayloadLength, &ucRpcTxFrame[ 3 ], &ucResponseLength);
+            configASSERT(ucResponseLength <= rpcMAX_PAYLOAD);
+        }
+    }
+
+    ucRpcTxFrame[ 1 ] = pucData[ 0 ];
+    ucRpcTxFrame[ 2 ] = ucStatus;
+    ucLength = ucResponseLength + 2;
+
+    usCRC = usRpcCRC16(rpcCRC_INITIAL, &ucRpcTxFrame[ 1 ], ucLength);
+    ucRpcTxFrame[ ucLength + 1 ] = (uint8_t) usCRC;
+    ucRpcTxFrame[ ucLength + 2 ] = (uint8_t) (usCRC >> 8);
+
+    ucLength = prvCOBSEncode(ucRpcTxFrame, ucLength + 2);
+    (void) xSerialWriteDescriptor(xRpcPort, ucRpcTxFrame, ucLength, serDESCRIPTOR_XRAM);
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvCOBSDecode(uint8_t *pucFrame, uint8_t ucLength)
+{
+    uint8_t ucIndex = 0;
+    uint8_t ucCode;
+
+    /* Each code byte gives the distance to the next, where the data had a
+    zero.  Writing the zero back over it leaves the data one byte along. */
+    while(ucIndex < ucLength)
+    {
+        ucCode = pucFrame[ ucIndex ];
+
+        if((ucCode == 0) || ((uint16_t) ucIndex + ucCode > ucLength))
+        {
+            return 0;
+        }
+
+        pucFrame[ ucIndex ] = 0;
+        ucIndex += ucCode;
+    }
+
+    return ucLength - 1;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvCOBSEncode(uint8_t *pucFrame, uint8_t ucLength)
+{
+    uint8_t ucIndex, ucCodeIndex = 0, ucCode = 1;
+
+    /* Each zero in the data is replaced by the distance to the next one, or
+    to the end, and the distance to the first goes in front. */
+    for(ucIndex = 1; ucIndex <= ucLength; ucIndex++)
+    {
+        if(pucFrame[ ucIndex ] == 0)
+        {
+            pucFrame[ ucCodeIndex ] = ucCode;
+            ucCodeIndex = ucIndex;
+            ucCode = 1;
+        }
+        else
+        {
+            ucCode++;
+        }
+    }
+
+    pucFrame[ ucCodeIndex ] = ucCode;
+    pucFrame[ ucLength + 1 ] = 0;
+
+    return ucLength + 2;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_RPC */
@@ -25,145 +25,1505 @@
  */
 
 
-/* BASIC INTERRUPT DRIVEN SERIAL PORT DRIVER FOR DEMO PURPOSES */
+/* BASIC INTERRUPT DRIVEN SERIAL PORT DRIVER FOR DEMO PURPOSES
+
+Serves UART0 and, when configSERIAL_USE_UART1 is 1, UART1.  Each port has its
+own SerialPort_t in XRAM, and the xComPortHandle returned by the init functions
+points to it.  A NULL handle means UART0, as before.
+
+The Rx and Tx characters of each port are held in two single-producer/
+single-consumer rings in XRAM rather than in queues.  The ISR only moves a
+byte in or out of a ring, and only calls into the kernel when a task is
+blocked on the ring and the level that task is waiting for has been reached.
+The ring indices are single bytes that run freely and are only ever advanced
+by one side, so the number of bytes held is always ( head - tail ) in eight
+bit arithmetic. */
 #include <stdlib.h>
 #include "FreeRTOS.h"
-#include "queue.h"
 #include "task.h"
 #include "serial.h"
+#include "active_object.h"
+#include "port_mem.h"
+
+/* Ring sizes, the same for every port.  Both must be a power of two no larger
+than 128. */
+#ifndef configSERIAL_RX_BUFFER_SIZE
+    #define configSERIAL_RX_BUFFER_SIZE     (32)
+#endif
+
+#ifndef configSERIAL_TX_BUFFER_SIZE
+    #define configSERIAL_TX_BUFFER_SIZE     (32)
+#endif
+
+/* Number of buffered characters that wakes a task blocked in uxSerialRead(),
+until changed by vSerialSetRxTriggerLevel(). */
+#ifndef configSERIAL_RX_TRIGGER_LEVEL
+    #define configSERIAL_RX_TRIGGER_LEVEL   (1)
+#endif
+
+/* Clock of the UART baud rate generators, twice the CPU clock.  Must be
+usable in #if, see FreeRTOSConfig.h. */
+#ifndef configSERIAL_CLOCK_HZ
+    #define configSERIAL_CLOCK_HZ           (configCPU_CLOCK_HZ * 2UL)
+#endif
+
+/* Largest baud rate error accepted, in tenths of a percent. */
+#ifndef configSERIAL_MAX_BAUD_ERROR_PERMILLE
+    #define configSERIAL_MAX_BAUD_ERROR_PERMILLE    (20)
+#endif
+
+/* Serve UART1 as well as UART0. */
+#ifndef configSERIAL_USE_UART1
+    #define configSERIAL_USE_UART1          (0)
+#endif
+
+/* Routes the UART1 pins.  Which pins UART1 can use depends on the package,
+so this is left to the application. */
+#ifndef configSERIAL_UART1_PIN_SETUP
+    #define configSERIAL_UART1_PIN_SETUP()
+#endif
+
+/* Keep the per-port counters returned by vSerialGetStats(). */
+#ifndef configSERIAL_USE_STATS
+    #define configSERIAL_USE_STATS          (0)
+#endif
+
+/* GPIO based RTS/CTS flow control.  configSERIAL_SET_RTS(ucUART, xStop) must
+drive the RTS output of UART ucUART to tell the other end to stop (xStop is
+pdTRUE) or carry on sending, and configSERIAL_CTS_READY(ucUART) must evaluate
+to non-zero while the other end's CTS allows this end to send. */
+#ifndef configSERIAL_USE_FLOW_CONTROL
+    #define configSERIAL_USE_FLOW_CONTROL   (0)
+#endif
+
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+    #if !defined(configSERIAL_SET_RTS) || !defined(configSERIAL_CTS_READY)
+        #error configSERIAL_SET_RTS() and configSERIAL_CTS_READY() must be defined to use flow control
+    #endif
+
+    /* Rx ring fill at which RTS tells the other end to stop, leaving room for
+    the characters it may already have in flight, and the fill at which it is
+    allowed to carry on. */
+    #ifndef configSERIAL_RTS_STOP_LEVEL
+        #define configSERIAL_RTS_STOP_LEVEL     (configSERIAL_RX_BUFFER_SIZE - 4)
+    #endif
+
+    #ifndef configSERIAL_RTS_START_LEVEL
+        #define configSERIAL_RTS_START_LEVEL    (configSERIAL_RX_BUFFER_SIZE / 2)
+    #endif
+#endif
+
+/* Receive mode that delivers whole frames delimited by a gap in the line,
+timed by timer 1.  See vSerialSetFrameMode().  UART0 only. */
+#ifndef configSERIAL_USE_FRAME_MODE
+    #define configSERIAL_USE_FRAME_MODE     (0)
+#endif
+
+#ifndef configSERIAL_FRAME_SIZE
+    #define configSERIAL_FRAME_SIZE         (64)
+#endif
+
+/* Receive mode that fills two application buffers in turn, handing each to
+the reading task when it is full or the line goes idle.  See
+vSerialSetRxBuffers().  UART0 only. */
+#ifndef configSERIAL_USE_RX_BUFFERS
+    #define configSERIAL_USE_RX_BUFFERS     (0)
+#endif
+
+/* Input clock of timer 1, which times the gap that ends a frame or marks the
+line idle.  One count per machine cycle of the CPU, as in i2c_master_timer.c. */
+#ifndef configSERIAL_FRAME_TIMER_HZ
+    #define configSERIAL_FRAME_TIMER_HZ     (configCPU_CLOCK_HZ / 12UL)
+#endif
+
+#if (configSERIAL_USE_FRAME_MODE == 1) || (configSERIAL_USE_RX_BUFFERS == 1)
+    #define serUSE_IDLE_TIMER   (1)
+#else
+    #define serUSE_IDLE_TIMER   (0)
+#endif
+
+#if (configSERIAL_USE_UART1 == 1)
+    #define serNUM_PORTS        (2)
+#else
+    #define serNUM_PORTS        (1)
+#endif
+
+/* Error flags in UARTn_STATE, each cleared by writing it back as zero. */
+#define serSTATE_FRAME_ERROR    ((uint8_t) 0x01)
+#define serSTATE_PARITY_ERROR   ((uint8_t) 0x02)
+#define serSTATE_OVERRUN        ((uint8_t) 0x04)
+
+#if (configSERIAL_USE_STATS == 1)
+    #define serSTAT_INC(pxSerial, xMember)     ((pxSerial)->xStats.xMember++)
+#else
+    #define serSTAT_INC(pxSerial, xMember)
+#endif
+
+/* UART1 takes the interrupt vector and the IEN2/IRCON2/IPL2 bit that follow
+those of UART0. */
+#define serUART0_IRQ_BIT        ((uint8_t) 0x04)
+#define serUART1_IRQ_BIT        ((uint8_t) 0x08)
+
+/* Largest value of the 10 bit baud rate divisor. */
+#define serMAX_BAUD_DIVISOR     (1023UL)
+
+/* Divisor for ulBaud at configSERIAL_CLOCK_HZ, or zero if ulBaud cannot be
+reached within configSERIAL_MAX_BAUD_ERROR_PERMILLE. */
+#define serBAUD_DIVISOR(ulBaud)                                                         \
+    (((serialBAUD_DIVISOR(configSERIAL_CLOCK_HZ, ulBaud) >= 1UL) &&                     \
+      (serialBAUD_DIVISOR(configSERIAL_CLOCK_HZ, ulBaud) <= serMAX_BAUD_DIVISOR) &&     \
+      (serialBAUD_ERROR_PERMILLE(configSERIAL_CLOCK_HZ, ulBaud) <= configSERIAL_MAX_BAUD_ERROR_PERMILLE)) ? \
+     serialBAUD_DIVISOR(configSERIAL_CLOCK_HZ, ulBaud) : 0UL)
+
+/* One entry of xBaudRates[], all worked out by the compiler. */
+#define serBAUD_RATE(ulBaud)    { (ulBaud), (uint16_t) serBAUD_DIVISOR(ulBaud), (uint16_t) serialBAUD_ERROR_PERMILLE(configSERIAL_CLOCK_HZ, ulBaud) }
+
+/* Number of times the loopback test polls the UART for each character before
+giving up.  Generous for the slowest rate the divisor can reach. */
+#define serLOOPBACK_POLLS       (0xffffU)
+
+/* What prvRxWait() waits for. */
+#define serWAIT_RING            ((uint8_t) 0)
+#define serWAIT_FRAME           ((uint8_t) 1)
+#define serWAIT_BUFFER          ((uint8_t) 2)
+
+#define serRX_BUFFER_SIZE       ((uint8_t) configSERIAL_RX_BUFFER_SIZE)
+#define serTX_BUFFER_SIZE       ((uint8_t) configSERIAL_TX_BUFFER_SIZE)
+#define serRX_MASK              ((uint8_t) (serRX_BUFFER_SIZE - 1))
+#define serTX_MASK              ((uint8_t) (serTX_BUFFER_SIZE - 1))
+
+#if ((configSERIAL_RX_BUFFER_SIZE & (configSERIAL_RX_BUFFER_SIZE - 1)) != 0) || (configSERIAL_RX_BUFFER_SIZE > 128)
+    #error configSERIAL_RX_BUFFER_SIZE must be a power of two no larger than 128
+#endif
+
+#if ((configSERIAL_TX_BUFFER_SIZE & (configSERIAL_TX_BUFFER_SIZE - 1)) != 0) || (configSERIAL_TX_BUFFER_SIZE > 128)
+    #error configSERIAL_TX_BUFFER_SIZE must be a power of two no larger than 128
+#endif
+
+#if (configSERIAL_FRAME_SIZE > 255)
+    #error configSERIAL_FRAME_SIZE must be no larger than 255
+#endif
+
+#define serTIMER1_MODE_16BIT    ((uint8_t) 0x10)
+#define serTIMER1_MODE_MASK     ((uint8_t) 0xf0)
+
+#define serRX_COUNT(pxSerial)   ((uint8_t) ((pxSerial)->ucRxHead - (pxSerial)->ucRxTail))
+#define serTX_COUNT(pxSerial)   ((uint8_t) ((pxSerial)->ucTxHead - (pxSerial)->ucTxTail))
+
+/* Map a handle onto its port structure.  NULL is UART0. */
+#define serPORT(pxPort)         (((pxPort) == NULL) ? &xSerialPorts[ 0 ] : (portXRAM_POINTER SerialPort_t *) (pxPort))
+
+typedef struct xSERIAL_PORT
+{
+    uint8_t ucRxRing[ serRX_BUFFER_SIZE ];
+    uint8_t ucTxRing[ serTX_BUFFER_SIZE ];
+
+    /* ucRxHead and ucTxTail are only advanced by the ISR, ucRxTail and
+    ucTxHead only by tasks. */
+    volatile uint8_t ucRxHead;
+    volatile uint8_t ucRxTail;
+    volatile uint8_t ucTxHead;
+    volatile uint8_t ucTxTail;
+
+    /* The task (if any) blocked on each ring, and the number of buffered (Rx)
+    or free (Tx) bytes it is waiting for. */
+    TaskHandle_t xRxWaitingTask;
+    TaskHandle_t xTxWaitingTask;
+    uint8_t ucRxWaitLevel;
+    uint8_t ucTxWaitLevel;
+
+    uint8_t ucRxTriggerLevel;
+
+    /* Set while the transmitter is idle, so the next write must start it. */
+    volatile uint8_t ucTxEmpty;
+
+    /* The Tx descriptor in flight, if any.  Its characters are sent straight
+    from the caller's buffer once the Tx ring is empty.  Only one of the two
+    pointers is used, depending on serDESCRIPTOR_CODE. */
+    code const uint8_t *pucTxDescriptorCode;
+    portXRAM_POINTER uint8_t *pucTxDescriptorXRAM;
+    volatile uint16_t usTxDescriptorLength;
+    uint8_t ucTxDescriptorFlags;
+    TaskHandle_t xTxDescriptorTask;
+
+#if (configUSE_ACTIVE_OBJECTS == 1)
+    /* When not NULL received characters are posted to this object instead of
+    the Rx ring. */
+    portXRAM_POINTER ActiveObject_t *pxRxActiveObject;
+    uint8_t ucRxSignal;
+#endif
+
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+    /* Set while RTS is telling the other end to stop. */
+    volatile uint8_t ucRTSStopped;
+#endif
+
+#if (configSERIAL_USE_STATS == 1)
+    SerialStats_t xStats;
+#endif
+
+    /* Error of the baud rate the port was set up with, in tenths of a
+    percent. */
+    uint16_t usBaudError;
+
+    /* 0 for UART0, 1 for UART1. */
+    uint8_t ucUART;
+} SerialPort_t;
+
+/* A baud rate with its divisor and error at configSERIAL_CLOCK_HZ. */
+typedef struct xSERIAL_BAUD_RATE
+{
+    unsigned long ulBaud;
+    uint16_t usDivisor;     /* Zero if the rate cannot be reached. */
+    uint16_t usError;       /* Tenths of a percent. */
+} SerialBaudRate_t;
+
+portCOLD_DATA static SerialPort_t xSerialPorts[ serNUM_PORTS ];
+
+/* Every eBaud value, in eBaud order, with its divisor and error worked out at
+compile time so xSerialPortInit() and xSerialPortInitMinimal() do not need a
+32 bit division for any of them. */
+static code const SerialBaudRate_t xBaudRates[] =
+{
+    serBAUD_RATE(50UL), serBAUD_RATE(75UL), serBAUD_RATE(110UL), serBAUD_RATE(134UL),
+    serBAUD_RATE(150UL), serBAUD_RATE(200UL), serBAUD_RATE(300UL), serBAUD_RATE(600UL),
+    serBAUD_RATE(1200UL), serBAUD_RATE(1800UL), serBAUD_RATE(2400UL), serBAUD_RATE(4800UL),
+    serBAUD_RATE(9600UL), serBAUD_RATE(19200UL), serBAUD_RATE(38400UL), serBAUD_RATE(57600UL),
+    serBAUD_RATE(115200UL), serBAUD_RATE(230400UL), serBAUD_RATE(250000UL), serBAUD_RATE(460800UL),
+    serBAUD_RATE(500000UL), serBAUD_RATE(921600UL), serBAUD_RATE(1000000UL)
+};
+
+#define serNUM_BAUD_RATES   (sizeof(xBaudRates) / sizeof(xBaudRates[ 0 ]))
+
+#if (serUSE_IDLE_TIMER == 1)
+    /* Baud rate of UART0, used to convert the idle gap from bit times to
+    timer 1 counts. */
+    portCOLD_DATA static unsigned long ulSerialBaud;
+
+    /* Timer 1 reload value that expires one gap after the last character, or
+    zero while neither frame mode nor the Rx buffers are in use. */
+    portWARM_DATA static volatile uint16_t usIdleReload;
+#endif
+
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+    /* The application buffer being filled by the ISR (NULL while the mode is
+    off), the other application buffer, and the size of both. */
+    static portXRAM_POINTER uint8_t *portWARM_DATA pucRxBufferActive;
+    static portXRAM_POINTER uint8_t *portWARM_DATA pucRxBufferOther;
+    portWARM_DATA static uint16_t usRxBufferSize;
+
+    /* Characters in the active buffer. */
+    portWARM_DATA static volatile uint16_t usRxBufferFill;
+
+    /* Characters in the other buffer while it is held by the reading task,
+    zero when it is free for the ISR to swap to. */
+    portWARM_DATA static volatile uint16_t usRxBufferReady;
+
+    /* Characters lost because both buffers were full. */
+    portWARM_DATA static volatile uint16_t usRxBufferOverruns;
+#endif
+
+#if (configSERIAL_USE_FRAME_MODE == 1)
+    portCOLD_DATA static uint8_t ucFrameBuffer[ configSERIAL_FRAME_SIZE ];
+
+    /* Characters collected for the frame being received. */
+    portWARM_DATA static volatile uint8_t ucFrameLength;
+
+    /* Length of the completed frame the consumer has not released yet, zero
+    when the buffer is free. */
+    portWARM_DATA static volatile uint8_t ucFrameReady;
+
+    /* Set when the frame being received is too long, or arrived while the
+    buffer was still held, so must be thrown away when the gap is seen. */
+    portWARM_DATA static volatile uint8_t ucFrameDiscard;
+
+    portWARM_DATA static volatile uint8_t ucFrameErrors;
+#endif
+
+/*
+ * Reset the port structure and set up UART ucUART at ulWantedBaud, 8N1, using
+ * baud rate divisor usDivisor.
+ */
+static xComPortHandle prvPortInit(uint8_t ucUART, unsigned long ulWantedBaud, uint16_t usDivisor, uint16_t usError);
+
+/*
+ * Send ucChar on UART ucUART, poll for it to come back and return pdPASS if it
+ * came back unchanged and without errors.
+ */
+static portBASE_TYPE prvLoopbackChar(uint8_t ucUART, uint8_t ucChar);
+
+/*
+ * Store a received character in the Rx ring of pxSerial, or post it to the
+ * port's active object.
+ */
+static void prvRxChar(portXRAM_POINTER SerialPort_t *pxSerial, uint8_t ucChar, portBASE_TYPE *pxHigherPriorityTaskWoken);
+
+/*
+ * Take the next character for Tx, first from the Tx ring and then from the
+ * descriptor in flight, and wake any task that was waiting for it.
+ */
+static portBASE_TYPE prvTxNext(portXRAM_POINTER SerialPort_t *pxSerial, uint8_t *pucChar, portBASE_TYPE *pxHigherPriorityTaskWoken);
+
+/*
+ * Start the transmitter of pxSerial if it is idle and there is something to
+ * send.
+ */
+static void prvTxStart(portXRAM_POINTER SerialPort_t *pxSerial);
+
+/*-----------------------------------------------------------*/
+
+xComPortHandle xSerialPortInitMinimal(unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength)
+{
+    uint8_t ucRate;
+    unsigned long ulDivisor;
+    uint16_t usError;
+
+    /* The rings are statically allocated, so uxQueueLength can only be
+    checked against them. */
+    configASSERT(uxQueueLength <= serRX_BUFFER_SIZE);
+    configASSERT(uxQueueLength <= serTX_BUFFER_SIZE);
+    (void) uxQueueLength;
+
+    /* The standard rates come from the table.  Anything else is worked out
+    here, once. */
+    for(ucRate = 0; ucRate < serNUM_BAUD_RATES; ucRate++)
+    {
+        if(xBaudRates[ ucRate ].ulBaud == ulWantedBaud)
+        {
+            break;
+        }
+    }
+
+    if(ucRate < serNUM_BAUD_RATES)
+    {
+        ulDivisor = xBaudRates[ ucRate ].usDivisor;
+        usError = xBaudRates[ ucRate ].usError;
+    }
+    else if(ulWantedBaud != 0)
+    {
+        ulDivisor = serialBAUD_DIVISOR(configSERIAL_CLOCK_HZ, ulWantedBaud);
+        usError = (uint16_t) serialBAUD_ERROR_PERMILLE(configSERIAL_CLOCK_HZ, ulWantedBaud);
+        if((ulDivisor > serMAX_BAUD_DIVISOR) || (usError > configSERIAL_MAX_BAUD_ERROR_PERMILLE))
+        {
+            ulDivisor = 0;
+        }
+    }
+    else
+    {
+        ulDivisor = 0;
+        usError = 0;
+    }
+
+    configASSERT(ulDivisor != 0);
+    if(ulDivisor == 0)
+    {
+        return NULL;
+    }
+
+    return prvPortInit(0, ulWantedBaud, (uint16_t) ulDivisor, usError);
+}
+/*-----------------------------------------------------------*/
+
+xComPortHandle xSerialPortInit(eCOMPort ePort, eBaud eWantedBaud, eParity eWantedParity, eDataBits eWantedDataBits, eStopBits eWantedStopBits, unsigned portBASE_TYPE uxBufferLength)
+{
+    /* Only 8N1 is supported. */
+    if((eWantedParity != serNO_PARITY) || (eWantedDataBits != serBITS_8) || (eWantedStopBits != serSTOP_1))
+    {
+        return NULL;
+    }
+
+    configASSERT(uxBufferLength <= serRX_BUFFER_SIZE);
+    configASSERT(uxBufferLength <= serTX_BUFFER_SIZE);
+    (void) uxBufferLength;
+
+    if(((uint8_t) ePort >= serNUM_PORTS) || ((uint8_t) eWantedBaud >= serNUM_BAUD_RATES))
+    {
+        return NULL;
+    }
+
+    /* Refuse rates that the divisor cannot reach closely enough at this
+    clock. */
+    if(xBaudRates[ eWantedBaud ].usDivisor == 0)
+    {
+        return NULL;
+    }
+
+    return prvPortInit((uint8_t) ePort, xBaudRates[ eWantedBaud ].ulBaud, xBaudRates[ eWantedBaud ].usDivisor, xBaudRates[ eWantedBaud ].usError);
+}
+/*-----------------------------------------------------------*/
+
+static xComPortHandle prvPortInit(uint8_t ucUART, unsigned long ulWantedBaud, uint16_t usDivisor, uint16_t usError)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = &xSerialPorts[ ucUART ];
+    unsigned char ucOriginalSFRPage;
+
+    /* Only needed to time the idle gap. */
+    (void) ulWantedBaud;
+
+    portENTER_CRITICAL();
+    {
+        ucOriginalSFRPage = SFRPAGE;
+
+        SFRPAGE = 0;
+
+        pxSerial->ucRxHead = 0;
+        pxSerial->ucRxTail = 0;
+        pxSerial->ucTxHead = 0;
+        pxSerial->ucTxTail = 0;
+        pxSerial->xRxWaitingTask = NULL;
+        pxSerial->xTxWaitingTask = NULL;
+        pxSerial->ucRxTriggerLevel = configSERIAL_RX_TRIGGER_LEVEL;
+        pxSerial->ucTxEmpty = pdTRUE;
+        pxSerial->usTxDescriptorLength = 0;
+        pxSerial->xTxDescriptorTask = NULL;
+#if (configUSE_ACTIVE_OBJECTS == 1)
+        pxSerial->pxRxActiveObject = NULL;
+#endif
+        pxSerial->ucUART = ucUART;
+        pxSerial->usBaudError = usError;
+#if (configSERIAL_USE_STATS == 1)
+        vPortXFill((xdata void *) &(pxSerial->xStats), 0x00, sizeof(SerialStats_t));
+#endif
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+        pxSerial->ucRTSStopped = pdFALSE;
+        configSERIAL_SET_RTS(ucUART, pdFALSE);
+#endif
+
+        EA = 0;
+
+#if (configSERIAL_USE_UART1 == 1)
+        if(ucUART != 0)
+        {
+            IPL2 |= serUART1_IRQ_BIT;
+            IRCON2 &= ~serUART1_IRQ_BIT;
+
+            configSERIAL_UART1_PIN_SETUP();
+
+            UART1_BDL = (uint8_t) usDivisor;
+            UART1_CON2 = ((uint8_t)(usDivisor >> 8) & 0x03);
+            UART1_CON2 |= (0x08);
+            UART1_CON2 |= (0x04);
+            UART1_CON1 |= (0x40);
+            UART1_CON1 &= (~0x10);
+            UART1_CON1 |= (0x20);
+            UART1_CON1 &= (~0x04);
+            UART1_CON1 |= (0x08);
+            UART1_CON1 &= (~0x02);
+            UART1_CON1 |= (0x01);
+            UART1_STATE &= ((~0x08) & (~0x10));
+            IEN2 |= serUART1_IRQ_BIT;
+        }
+        else
+#endif
+        {
+#if (serUSE_IDLE_TIMER == 1)
+            ulSerialBaud = ulWantedBaud;
+            usIdleReload = 0;
+
+            /* Timer 1 is a 16 bit one-shot, restarted by every received
+            character while frame mode or the Rx buffers are in use. */
+            TR1 = 0;
+            TF1 = 0;
+            TMOD = (TMOD & ~serTIMER1_MODE_MASK) | serTIMER1_MODE_16BIT;
+            ET1 = 1;
+#endif
+
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+            pucRxBufferActive = NULL;
+            usRxBufferReady = 0;
+            usRxBufferOverruns = 0;
+#endif
+
+#if (configSERIAL_USE_FRAME_MODE == 1)
+            ucFrameLength = 0;
+            ucFrameReady = 0;
+            ucFrameDiscard = pdFALSE;
+            ucFrameErrors = 0;
+#endif
+
+            IPL2 |= serUART0_IRQ_BIT;
+            IRCON2 &= ~serUART0_IRQ_BIT;
+            REG_ADDR = 0x34;
+            REG_DATA &= ~(0x60);
+            REG_DATA |= (0x60 & (1 << 5));
+
+            REG_ADDR = 0x1B;
+            REG_DATA |= 0x10;
+            REG_ADDR = 0x1B;
+            REG_DATA |= 0x20;
+            REG_ADDR = 0x27;
+            REG_DATA &= ~0x01;
+            TRISE |= 0x10;
+            REG_ADDR = 0x27;
+            REG_DATA &= ~0x02;
+            TRISE &= ~0x20;
+
+            UART0_BDL = (uint8_t) usDivisor;
+            UART0_CON2 = ((uint8_t)(usDivisor >> 8) & 0x03);
+            UART0_CON2 |= (0x08);
+            UART0_CON2 |= (0x04);
+            UART0_CON1 |= (0x40);
+            UART0_CON1 &= (~0x10);
+            UART0_CON1 |= (0x20);
+            UART0_CON1 &= (~0x04);
+            UART0_CON1 |= (0x08);
+            UART0_CON1 &= (~0x02);
+            UART0_CON1 |= (0x01);
+            UART0_STATE &= ((~0x08) & (~0x10));
+            IEN2 |= serUART0_IRQ_BIT;
+        }
+
+        SFRPAGE = ucOriginalSFRPage;
+    }
+    portEXIT_CRITICAL();
+
+    return (xComPortHandle) pxSerial;
+}
+/*-----------------------------------------------------------*/
+
+#if (serUSE_IDLE_TIMER == 1)
+
+/*
+ * Convert an idle gap in bit times at the current baud rate to a timer 1
+ * reload value.  The 32 bit division is only done here, not per character.
+ */
+static uint16_t prvGapToReload(unsigned portBASE_TYPE uxGapBitTimes)
+{
+    unsigned long ulCounts;
+
+    ulCounts = ((unsigned long) uxGapBitTimes * configSERIAL_FRAME_TIMER_HZ) / ulSerialBaud;
+    configASSERT((ulCounts != 0) && (ulCounts <= 0xffffUL));
+
+    return (uint16_t) (0x10000UL - ulCounts);
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+
+/*
+ * Hand the active Rx buffer to the reading task and carry on filling the
+ * other one, if the task has released it.  Must be called with interrupts
+ * masked.
+ */
+static void prvRxBufferSwap(portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+    portXRAM_POINTER uint8_t *pucFilled;
+
+    if((usRxBufferReady == 0) && (usRxBufferFill != 0))
+    {
+        pucFilled = pucRxBufferActive;
+        pucRxBufferActive = pucRxBufferOther;
+        pucRxBufferOther = pucFilled;
+        usRxBufferReady = usRxBufferFill;
+        usRxBufferFill = 0;
+
+        if(xSerialPorts[ 0 ].xRxWaitingTask != NULL)
+        {
+            vTaskNotifyGiveFromISR(xSerialPorts[ 0 ].xRxWaitingTask, pxHigherPriorityTaskWoken);
+            xSerialPorts[ 0 ].xRxWaitingTask = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+static void prvRxChar(portXRAM_POINTER SerialPort_t *pxSerial, uint8_t ucChar, portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+#if (configUSE_ACTIVE_OBJECTS == 1)
+    if(pxSerial->pxRxActiveObject != NULL)
+    {
+        xAOPostFromISR(pxSerial->pxRxActiveObject, pxSerial->ucRxSignal, ucChar, pxHigherPriorityTaskWoken);
+    }
+    else
+#endif
+    if(serRX_COUNT(pxSerial) < serRX_BUFFER_SIZE)
+    {
+        pxSerial->ucRxRing[ pxSerial->ucRxHead & serRX_MASK ] = ucChar;
+        pxSerial->ucRxHead++;
+        serSTAT_INC(pxSerial, usRxChars);
+
+#if (configSERIAL_USE_STATS == 1)
+        if(serRX_COUNT(pxSerial) > pxSerial->xStats.ucRxPeak)
+        {
+            pxSerial->xStats.ucRxPeak = serRX_COUNT(pxSerial);
+        }
+#endif
+
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+        if((pxSerial->ucRTSStopped == pdFALSE) && (serRX_COUNT(pxSerial) >= (uint8_t) configSERIAL_RTS_STOP_LEVEL))
+        {
+            configSERIAL_SET_RTS(pxSerial->ucUART, pdTRUE);
+            pxSerial->ucRTSStopped = pdTRUE;
+        }
+#endif
+
+        /* The reading task is only woken once the number of buffered
+        characters reaches the level it asked for. */
+        if((pxSerial->xRxWaitingTask != NULL) && (serRX_COUNT(pxSerial) >= pxSerial->ucRxWaitLevel))
+        {
+            vTaskNotifyGiveFromISR(pxSerial->xRxWaitingTask, pxHigherPriorityTaskWoken);
+            pxSerial->xRxWaitingTask = NULL;
+        }
+    }
+    else
+    {
+        /* The ring is full and the character is lost. */
+        serSTAT_INC(pxSerial, usRxDropped);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvTxNext(portXRAM_POINTER SerialPort_t *pxSerial, uint8_t *pucChar, portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+    if(!configSERIAL_CTS_READY(pxSerial->ucUART))
+    {
+        /* Leave the transmitter idle.  vSerialFlowControlPoll() starts it
+        again once CTS allows. */
+        if((pxSerial->ucTxHead != pxSerial->ucTxTail) || (pxSerial->usTxDescriptorLength != 0))
+        {
+            serSTAT_INC(pxSerial, usCTSStalls);
+        }
+
+        return pdFALSE;
+    }
+#endif
+
+    if(pxSerial->ucTxHead != pxSerial->ucTxTail)
+    {
+        *pucChar = pxSerial->ucTxRing[ pxSerial->ucTxTail & serTX_MASK ];
+        pxSerial->ucTxTail++;
+
+        if((pxSerial->xTxWaitingTask != NULL) && ((uint8_t)(serTX_BUFFER_SIZE - serTX_COUNT(pxSerial)) >= pxSerial->ucTxWaitLevel))
+        {
+            vTaskNotifyGiveFromISR(pxSerial->xTxWaitingTask, pxHigherPriorityTaskWoken);
+            pxSerial->xTxWaitingTask = NULL;
+        }
+    }
+    else if(pxSerial->usTxDescriptorLength != 0)
+    {
+        if((pxSerial->ucTxDescriptorFlags & serDESCRIPTOR_CODE) != 0)
+        {
+            *pucChar = *(pxSerial->pucTxDescriptorCode);
+            pxSerial->pucTxDescriptorCode++;
+        }
+        else
+        {
+            *pucChar = *(pxSerial->pucTxDescriptorXRAM);
+            pxSerial->pucTxDescriptorXRAM++;
+        }
+
+        pxSerial->usTxDescriptorLength--;
+
+        /* The last character is about to go into the UART, so the caller can
+        have its buffer back. */
+        if((pxSerial->usTxDescriptorLength == 0) && (pxSerial->xTxDescriptorTask != NULL))
+        {
+            vTaskNotifyGiveFromISR(pxSerial->xTxDescriptorTask, pxHigherPriorityTaskWoken);
+            pxSerial->xTxDescriptorTask = NULL;
+        }
+    }
+    else
+    {
+        return pdFALSE;
+    }
+
+    serSTAT_INC(pxSerial, usTxChars);
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTxStart(portXRAM_POINTER SerialPort_t *pxSerial)
+{
+    uint8_t ucChar;
+    portBASE_TYPE xUnused = pdFALSE;
+
+    /* The transmitter was idle, so no other task can be waiting on it. */
+    if((pxSerial->ucTxEmpty != pdFALSE) && (prvTxNext(pxSerial, &ucChar, &xUnused) != pdFALSE))
+    {
+        pxSerial->ucTxEmpty = pdFALSE;
+
+#if (configSERIAL_USE_UART1 == 1)
+        if(pxSerial->ucUART != 0)
+        {
+            UART1_BUF = ucChar;
+            UART1_STATE = 0x0F;
+        }
+        else
+#endif
+        {
+            UART0_BUF = ucChar;
+            UART0_STATE = 0x0F;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vSerialISR(void) interrupt(17)
+{
+    uint8_t ucChar;
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    /* 8051 port interrupt routines MUST be placed within a critical section
+    if taskYIELD() is used within the ISR! */
+
+    portENTER_CRITICAL();
+    {
+        IRCON2 &= ~serUART0_IRQ_BIT;
+        if(UART0_STATE & 0x08)
+        {
+            ucChar = UART0_BUF;
+            UART0_STATE = 0x17;
+#if (serUSE_IDLE_TIMER == 1)
+            if(usIdleReload != 0)
+            {
+                /* Restart the idle timeout from this character. */
+                TR1 = 0;
+                TH1 = (uint8_t) (usIdleReload >> 8);
+                TL1 = (uint8_t) usIdleReload;
+                TF1 = 0;
+                TR1 = 1;
+            }
+#endif
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+            if(pucRxBufferActive != NULL)
+            {
+                if(usRxBufferFill < usRxBufferSize)
+                {
+                    pucRxBufferActive[usRxBufferFill] = ucChar;
+                    usRxBufferFill++;
+
+                    if(usRxBufferFill == usRxBufferSize)
+                    {
+                        prvRxBufferSwap(&xHigherPriorityTaskWoken);
+                    }
+                }
+                else
+                {
+                    /* Both buffers are full. */
+                    usRxBufferOverruns++;
+                }
+            }
+            else
+#endif
+#if (configSERIAL_USE_FRAME_MODE == 1)
+            if(usIdleReload != 0)
+            {
+                if((ucFrameReady == 0) && (ucFrameLength < (uint8_t) configSERIAL_FRAME_SIZE))
+                {
+                    ucFrameBuffer[ucFrameLength] = ucChar;
+                    ucFrameLength++;
+                }
+                else
+                {
+                    ucFrameDiscard = pdTRUE;
+                }
+            }
+            else
+#endif
+            {
+                prvRxChar(&xSerialPorts[ 0 ], ucChar, &xHigherPriorityTaskWoken);
+            }
+        }
+        if(UART0_STATE & serSTATE_FRAME_ERROR)
+        {
+            UART0_STATE = 0x1E;
+            serSTAT_INC(&xSerialPorts[ 0 ], usFramingErrors);
+        }
+        if(UART0_STATE & serSTATE_PARITY_ERROR)
+        {
+            UART0_STATE = 0x1D;
+            serSTAT_INC(&xSerialPorts[ 0 ], usParityErrors);
+        }
+        if(UART0_STATE & serSTATE_OVERRUN)
+        {
+            UART0_STATE = 0x1B;
+            serSTAT_INC(&xSerialPorts[ 0 ], usHardwareOverruns);
+        }
+        if(UART0_STATE & 0x10)
+        {
+            UART0_STATE = 0x0F;
+            if(prvTxNext(&xSerialPorts[ 0 ], &ucChar, &xHigherPriorityTaskWoken) != pdFALSE)
+            {
+                UART0_BUF = ucChar;
+            }
+            else
+            {
+                /* Ring empty and no descriptor, nothing to send. */
+                xSerialPorts[ 0 ].ucTxEmpty = pdTRUE;
+            }
+        }
+
+        if(xHigherPriorityTaskWoken)
+        {
+            portYIELD();
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#if (configSERIAL_USE_UART1 == 1)
+
+void vSerial1ISR(void) interrupt(18)
+{
+    uint8_t ucChar;
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    /* 8051 port interrupt routines MUST be placed within a critical section
+    if taskYIELD() is used within the ISR! */
+
+    portENTER_CRITICAL();
+    {
+        IRCON2 &= ~serUART1_IRQ_BIT;
+        if(UART1_STATE & 0x08)
+        {
+            ucChar = UART1_BUF;
+            UART1_STATE = 0x17;
+            prvRxChar(&xSerialPorts[ 1 ], ucChar, &xHigherPriorityTaskWoken);
+        }
+        if(UART1_STATE & serSTATE_FRAME_ERROR)
+        {
+            UART1_STATE = 0x1E;
+            serSTAT_INC(&xSerialPorts[ 1 ], usFramingErrors);
+        }
+        if(UART1_STATE & serSTATE_PARITY_ERROR)
+        {
+            UART1_STATE = 0x1D;
+            serSTAT_INC(&xSerialPorts[ 1 ], usParityErrors);
+        }
+        if(UART1_STATE & serSTATE_OVERRUN)
+        {
+            UART1_STATE = 0x1B;
+            serSTAT_INC(&xSerialPorts[ 1 ], usHardwareOverruns);
+        }
+        if(UART1_STATE & 0x10)
+        {
+            UART1_STATE = 0x0F;
+            if(prvTxNext(&xSerialPorts[ 1 ], &ucChar, &xHigherPriorityTaskWoken) != pdFALSE)
+            {
+                UART1_BUF = ucChar;
+            }
+            else
+            {
+                xSerialPorts[ 1 ].ucTxEmpty = pdTRUE;
+            }
+        }
+
+        if(xHigherPriorityTaskWoken)
+        {
+            portYIELD();
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+#if (serUSE_IDLE_TIMER == 1)
+
+void vSerialFrameTimerISR(void) interrupt(3)
+{
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+    /* 8051 port interrupt routines MUST be placed within a critical section
+    if taskYIELD() is used within the ISR! */
+
+    portENTER_CRITICAL();
+    {
+        /* The line has been quiet for a whole gap. */
+        TR1 = 0;
+        TF1 = 0;
+
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+        if(pucRxBufferActive != NULL)
+        {
+            /* Hand over what has arrived so far. */
+            prvRxBufferSwap(&xHigherPriorityTaskWoken);
+        }
+        else
+#endif
+        {
+#if (configSERIAL_USE_FRAME_MODE == 1)
+            /* The frame is complete. */
+            if(ucFrameDiscard != pdFALSE)
+            {
+                ucFrameErrors++;
+            }
+            else if(ucFrameLength != 0)
+            {
+                ucFrameReady = ucFrameLength;
+
+                if(xSerialPorts[ 0 ].xRxWaitingTask != NULL)
+                {
+                    vTaskNotifyGiveFromISR(xSerialPorts[ 0 ].xRxWaitingTask, &xHigherPriorityTaskWoken);
+                    xSerialPorts[ 0 ].xRxWaitingTask = NULL;
+                }
+            }
+
+            ucFrameLength = 0;
+            ucFrameDiscard = pdFALSE;
+#endif
+        }
+
+        if(xHigherPriorityTaskWoken)
+        {
+            portYIELD();
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+/*
+ * Block the calling task for up to xBlockTime until ucLevel characters are
+ * in the Rx ring of pxSerial, or, depending on ucSource, until a complete
+ * frame or a filled Rx buffer is held.  Returns the number of characters in
+ * the ring, the frame length, or non-zero for a buffer, which is less than
+ * ucLevel if the block time expired first.
+ */
+static unsigned portBASE_TYPE prvRxWait(portXRAM_POINTER SerialPort_t *pxSerial, uint8_t ucSource, uint8_t ucLevel, TickType_t xBlockTime)
+{
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = xBlockTime;
+    unsigned portBASE_TYPE uxAvailable;
+
+    vTaskSetTimeOutState(&xTimeOut);
+
+    /* The ISR notifies this task once the level is reached, so it is woken
+    once per call rather than once per character. */
+    for(;;)
+    {
+        portENTER_CRITICAL();
+        {
+#if (configSERIAL_USE_FRAME_MODE == 1)
+            if(ucSource == serWAIT_FRAME)
+            {
+                uxAvailable = ucFrameReady;
+            }
+            else
+#endif
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+            if(ucSource == serWAIT_BUFFER)
+            {
+                uxAvailable = (usRxBufferReady != 0) ? 1 : 0;
+            }
+            else
+#endif
+            {
+                uxAvailable = serRX_COUNT(pxSerial);
+            }
+
+            if((uxAvailable < ucLevel) && (xTicksToWait != (TickType_t) 0))
+            {
+                /* Only one task can read from the port. */
+                configASSERT(pxSerial->xRxWaitingTask == NULL);
+                pxSerial->ucRxWaitLevel = ucLevel;
+                pxSerial->xRxWaitingTask = xTaskGetCurrentTaskHandle();
+            }
+        }
+        portEXIT_CRITICAL();
+
+        if((uxAvailable >= ucLevel) || (xTicksToWait == (TickType_t) 0))
+        {
+            break;
+        }
+
+        (void) ulTaskNotifyTake(pdTRUE, xTicksToWait);
+
+        portENTER_CRITICAL();
+        {
+            pxSerial->xRxWaitingTask = NULL;
+        }
+        portEXIT_CRITICAL();
+
+        if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+            /* Take whatever arrived before the timeout on the next pass. */
+            xTicksToWait = (TickType_t) 0;
+        }
+    }
+
+    (void) ucSource;
+
+    return uxAvailable;
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxSerialGetChars(xComPortHandle pxPort, signed char *pcRxedChars, unsigned portBASE_TYPE uxMaxChars, unsigned portBASE_TYPE uxMinChars, TickType_t xBlockTime)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+    unsigned portBASE_TYPE uxAvailable;
+    unsigned portBASE_TYPE uxCount;
+    uint8_t ucTail;
+
+    if(uxMaxChars > serRX_BUFFER_SIZE)
+    {
+        uxMaxChars = serRX_BUFFER_SIZE;
+    }
+
+    if(uxMinChars > uxMaxChars)
+    {
+        uxMinChars = uxMaxChars;
+    }
+
+    /* Wait for up to xBlockTime for uxMinChars characters, then take any
+    others that are already buffered, up to uxMaxChars. */
+    uxAvailable = prvRxWait(pxSerial, serWAIT_RING, (uint8_t) uxMinChars, xBlockTime);
+
+    if(uxAvailable > uxMaxChars)
+    {
+        uxAvailable = uxMaxChars;
+    }
+
+    /* Only this task advances the tail, so the copy needs no critical
+    section. */
+    ucTail = pxSerial->ucRxTail;
+
+    for(uxCount = 0; uxCount < uxAvailable; uxCount++)
+    {
+        pcRxedChars[ uxCount ] = (signed char) pxSerial->ucRxRing[ ucTail & serRX_MASK ];
+        ucTail++;
+    }
+
+    pxSerial->ucRxTail = ucTail;
+
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+    if(pxSerial->ucRTSStopped != pdFALSE)
+    {
+        portENTER_CRITICAL();
+        {
+            if(serRX_COUNT(pxSerial) <= (uint8_t) configSERIAL_RTS_START_LEVEL)
+            {
+                configSERIAL_SET_RTS(pxSerial->ucUART, pdFALSE);
+                pxSerial->ucRTSStopped = pdFALSE;
+            }
+        }
+        portEXIT_CRITICAL();
+    }
+#endif
 
-static QueueHandle_t xRxedChars;
-static QueueHandle_t xCharsForTx;
+    return uxAvailable;
+}
+/*-----------------------------------------------------------*/
 
-data static unsigned portBASE_TYPE uxTxEmpty;
+unsigned portBASE_TYPE uxSerialRead(xComPortHandle pxPort, void *pvBuffer, unsigned portBASE_TYPE uxMaxChars, TickType_t xBlockTime)
+{
+    /* Wait for the trigger level, or fewer if fewer were asked for. */
+    return uxSerialGetChars(pxPort, (signed char *) pvBuffer, uxMaxChars, serPORT(pxPort)->ucRxTriggerLevel, xBlockTime);
+}
+/*-----------------------------------------------------------*/
 
+void vSerialSetRxTriggerLevel(xComPortHandle pxPort, unsigned portBASE_TYPE uxLevel)
+{
+    configASSERT((uxLevel > 0) && (uxLevel <= serRX_BUFFER_SIZE));
+    serPORT(pxPort)->ucRxTriggerLevel = (uint8_t) uxLevel;
+}
 /*-----------------------------------------------------------*/
 
-xComPortHandle xSerialPortInitMinimal(unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength)
+#if (configSERIAL_USE_FRAME_MODE == 1)
+
+void vSerialSetFrameMode(xComPortHandle pxPort, unsigned portBASE_TYPE uxGapBitTimes)
 {
-    unsigned char ucOriginalSFRPage;
+    uint16_t usReload = 0;
+
+    /* Only UART0 has frame mode. */
+    configASSERT(serPORT(pxPort) == &xSerialPorts[ 0 ]);
+    (void) pxPort;
+
+    if(uxGapBitTimes != 0)
+    {
+        usReload = prvGapToReload(uxGapBitTimes);
+    }
 
     portENTER_CRITICAL();
     {
-        ucOriginalSFRPage = SFRPAGE;
+        TR1 = 0;
+        TF1 = 0;
+        usIdleReload = usReload;
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+        /* The two modes share timer 1, so frame mode turns the Rx buffers
+        off. */
+        pucRxBufferActive = NULL;
+#endif
+        ucFrameLength = 0;
+        ucFrameReady = 0;
+        ucFrameDiscard = pdFALSE;
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
 
-        SFRPAGE = 0;
+unsigned portBASE_TYPE uxSerialReceiveFrame(xComPortHandle pxPort, uint8_t **ppucFrame, TickType_t xBlockTime)
+{
+    unsigned portBASE_TYPE uxLength;
 
-        uxTxEmpty = pdTRUE;
+    configASSERT(serPORT(pxPort) == &xSerialPorts[ 0 ]);
+    (void) pxPort;
 
-        /* Create the queues used by the com test task. */
-        xRxedChars = xQueueCreate(uxQueueLength, (unsigned portBASE_TYPE) sizeof(char));
-        xCharsForTx = xQueueCreate(uxQueueLength, (unsigned portBASE_TYPE) sizeof(char));
+    uxLength = prvRxWait(&xSerialPorts[ 0 ], serWAIT_FRAME, 1, xBlockTime);
 
-        EA = 0;
-        IPL2 |= 0x04;
-        IRCON2 &= ~0x04;
-        REG_ADDR = 0x34;
-        REG_DATA &= ~(0x60);
-        REG_DATA |= (0x60 & (1 << 5));
-
-        REG_ADDR = 0x1B;
-        REG_DATA |= 0x10;
-        REG_ADDR = 0x1B;
-        REG_DATA |= 0x20;
-        REG_ADDR = 0x27;
-        REG_DATA &= ~0x01;
-        TRISE |= 0x10;
-        REG_ADDR = 0x27;
-        REG_DATA &= ~0x02;
-        TRISE &= ~0x20;
-
-        UART0_BDL = (24000000UL / (16UL * ulWantedBaud));
-        UART0_CON2 = ((uint8_t)((uint16_t)(24000000UL / (16UL * ulWantedBaud)) >> 8) & 0x03);
-        UART0_CON2 |= (0x08);
-        UART0_CON2 |= (0x04);
-        UART0_CON1 |= (0x40);
-        UART0_CON1 &= (~0x10);
-        UART0_CON1 |= (0x20);
-        UART0_CON1 &= (~0x04);
-        UART0_CON1 |= (0x08);
-        UART0_CON1 &= (~0x02);
-        UART0_CON1 |= (0x01);
-        UART0_STATE &= ((~0x08) & (~0x10));
-        IEN2 |= 0x04;
+    if(uxLength != 0)
+    {
+        *ppucFrame = ucFrameBuffer;
+    }
 
-        SFRPAGE = ucOriginalSFRPage;
+    return uxLength;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialReleaseFrame(xComPortHandle pxPort)
+{
+    (void) pxPort;
+
+    /* A single byte write, and the ISRs only set it while it is zero. */
+    ucFrameReady = 0;
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxSerialGetFrameErrors(xComPortHandle pxPort)
+{
+    (void) pxPort;
+
+    return ucFrameErrors;
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+#if (configSERIAL_USE_RX_BUFFERS == 1)
+
+void vSerialSetRxBuffers(xComPortHandle pxPort, uint8_t *pucBuffer1, uint8_t *pucBuffer2, unsigned short usBufferSize, unsigned portBASE_TYPE uxIdleBitTimes)
+{
+    uint16_t usReload = 0;
+
+    /* Only UART0 has the Rx buffers. */
+    configASSERT(serPORT(pxPort) == &xSerialPorts[ 0 ]);
+    (void) pxPort;
+
+    if((pucBuffer1 != NULL) && (uxIdleBitTimes != 0))
+    {
+        usReload = prvGapToReload(uxIdleBitTimes);
+    }
+
+    portENTER_CRITICAL();
+    {
+        TR1 = 0;
+        TF1 = 0;
+        usIdleReload = usReload;
+        usRxBufferSize = usBufferSize;
+        usRxBufferFill = 0;
+        usRxBufferReady = 0;
+        pucRxBufferOther = (portXRAM_POINTER uint8_t *) pucBuffer2;
+        pucRxBufferActive = (portXRAM_POINTER uint8_t *) pucBuffer1;
     }
     portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+unsigned short usSerialReceiveBuffer(xComPortHandle pxPort, uint8_t **ppucBuffer, TickType_t xBlockTime)
+{
+    unsigned short usLength = 0;
+
+    configASSERT(serPORT(pxPort) == &xSerialPorts[ 0 ]);
+    (void) pxPort;
+
+    if(prvRxWait(&xSerialPorts[ 0 ], serWAIT_BUFFER, 1, xBlockTime) != 0)
+    {
+        /* The ISR does not touch either while the buffer is held. */
+        *ppucBuffer = pucRxBufferOther;
+        usLength = usRxBufferReady;
+    }
 
-    /* Unlike some ports, this serial code does not allow for more than one
-    com port.  We therefore don't return a pointer to a port structure and can
-    instead just return NULL. */
-    return NULL;
+    return usLength;
 }
 /*-----------------------------------------------------------*/
 
-void vSerialISR(void) interrupt(17)
+void vSerialReleaseBuffer(xComPortHandle pxPort)
 {
-    char cChar;
     portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-    /* 8051 port interrupt routines MUST be placed within a critical section
-    if taskYIELD() is used within the ISR! */
+    (void) pxPort;
 
     portENTER_CRITICAL();
     {
-        IRCON2 &= ~0x04;
-        if(UART0_STATE & 0x08)
+        usRxBufferReady = 0;
+
+        /* If the active buffer filled up, or the line went idle, while this
+        one was held, hand it over now rather than waiting for more data. */
+        if((usRxBufferFill == usRxBufferSize) || ((usRxBufferFill != 0) && (usIdleReload != 0) && (TR1 == 0)))
         {
-            /* Get the character and post it on the queue of Rxed characters.
-            If the post causes a task to wake force a context switch if the woken task
-            has a higher priority than the task we have interrupted. */
-            cChar = UART0_BUF;
-            UART0_STATE = 0x17;
-            xQueueSendFromISR(xRxedChars, &cChar, &xHigherPriorityTaskWoken);
+            prvRxBufferSwap(&xHigherPriorityTaskWoken);
         }
-        if(UART0_STATE & 0x01)
+    }
+    portEXIT_CRITICAL();
+
+    /* The calling task is the reader, so nothing else can have been woken. */
+    (void) xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+unsigned short usSerialGetBufferOverruns(xComPortHandle pxPort)
+{
+    unsigned short usOverruns;
+
+    (void) pxPort;
+
+    portENTER_CRITICAL();
+    {
+        usOverruns = usRxBufferOverruns;
+    }
+    portEXIT_CRITICAL();
+
+    return usOverruns;
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+portBASE_TYPE xSerialGetChar(xComPortHandle pxPort, signed char *pcRxedChar, TickType_t xBlockTime)
+{
+    /* Get the next character from the buffer.  Return false if no characters
+    are available, or arrive before xBlockTime expires. */
+    if(uxSerialGetChars(pxPort, pcRxedChar, 1, 1, xBlockTime) != 0)
+    {
+        return (portBASE_TYPE) pdTRUE;
+    }
+    else
+    {
+        return (portBASE_TYPE) pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxSerialWrite(xComPortHandle pxPort, const void *pvData, unsigned portBASE_TYPE uxLength, TickType_t xBlockTime)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+    const uint8_t *pucData = (const uint8_t *) pvData;
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = xBlockTime;
+    unsigned portBASE_TYPE uxSent = 0;
+    unsigned portBASE_TYPE uxRemaining;
+    portBASE_TYPE xBlocked;
+
+    vTaskSetTimeOutState(&xTimeOut);
+
+    for(;;)
+    {
+        xBlocked = pdFALSE;
+
+        /* More than one task may write, so the ring is filled with interrupts
+        masked.  That costs a few cycles per byte, against the full queue
+        operation per byte it replaces. */
+        portENTER_CRITICAL();
         {
-            UART0_STATE = 0x1E;
+            while((uxSent < uxLength) && (serTX_COUNT(pxSerial) < serTX_BUFFER_SIZE))
+            {
+                pxSerial->ucTxRing[ pxSerial->ucTxHead & serTX_MASK ] = pucData[ uxSent ];
+                pxSerial->ucTxHead++;
+                uxSent++;
+            }
+
+#if (configSERIAL_USE_STATS == 1)
+            if(serTX_COUNT(pxSerial) > pxSerial->xStats.ucTxPeak)
+            {
+                pxSerial->xStats.ucTxPeak = serTX_COUNT(pxSerial);
+            }
+
+            if(uxSent < uxLength)
+            {
+                /* The writer has to wait, or give up, for want of room. */
+                pxSerial->xStats.usTxFull++;
+            }
+#endif
+
+            /* From then on the Tx ISR keeps it going until the ring is
+            empty. */
+            prvTxStart(pxSerial);
+
+            uxRemaining = uxLength - uxSent;
+
+            if((uxRemaining != 0) && (xTicksToWait != (TickType_t) 0) && (pxSerial->xTxWaitingTask == NULL))
+            {
+                /* Ask to be woken when the rest fits, or when half the ring is
+                free if the rest is larger than that. */
+                if(uxRemaining > (serTX_BUFFER_SIZE / 2))
+                {
+                    uxRemaining = serTX_BUFFER_SIZE / 2;
+                }
+
+                pxSerial->ucTxWaitLevel = (uint8_t) uxRemaining;
+                pxSerial->xTxWaitingTask = xTaskGetCurrentTaskHandle();
+                xBlocked = pdTRUE;
+            }
         }
-        if(UART0_STATE & 0x02)
+        portEXIT_CRITICAL();
+
+        if((uxSent == uxLength) || (xTicksToWait == (TickType_t) 0))
         {
-            UART0_STATE = 0x1D;
+            break;
         }
-        if(UART0_STATE & 0x04)
+
+        if(xBlocked != pdFALSE)
         {
-            UART0_STATE = 0x1B;
+            (void) ulTaskNotifyTake(pdTRUE, xTicksToWait);
+
+            portENTER_CRITICAL();
+            {
+                if(pxSerial->xTxWaitingTask == xTaskGetCurrentTaskHandle())
+                {
+                    pxSerial->xTxWaitingTask = NULL;
+                }
+            }
+            portEXIT_CRITICAL();
         }
-        if(UART0_STATE & 0x10)
+        else
         {
-            UART0_STATE = 0x0F;
-            if(xQueueReceiveFromISR(xCharsForTx, &cChar, &xHigherPriorityTaskWoken) == (portBASE_TYPE) pdTRUE)
+            /* Another writer already holds the wait slot, so poll instead. */
+            vTaskDelay((TickType_t) 1);
+        }
+
+        if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+            /* Copy whatever now fits on the next pass, then give up. */
+            xTicksToWait = (TickType_t) 0;
+        }
+    }
+
+    return uxSent;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xSerialWriteDescriptor(xComPortHandle pxPort, const void *pvData, unsigned short usLength, unsigned char ucFlags)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+    portBASE_TYPE xReturn = pdFAIL;
+
+    if(usLength == 0)
+    {
+        return pdPASS;
+    }
+
+    portENTER_CRITICAL();
+    {
+        /* Only one descriptor per port can be in flight. */
+        if(pxSerial->usTxDescriptorLength == 0)
+        {
+            /* The memory space is given by ucFlags, so only the address part
+            of the generic pointer is kept. */
+            if((ucFlags & serDESCRIPTOR_CODE) != 0)
             {
-                /* Send the next character queued for Tx. */
-                UART0_BUF = cChar;
+                pxSerial->pucTxDescriptorCode = (code const uint8_t *) pvData;
             }
             else
             {
-                /* Queue empty, nothing to send. */
-                uxTxEmpty = pdTRUE;
+                pxSerial->pucTxDescriptorXRAM = (portXRAM_POINTER uint8_t *) pvData;
             }
+
+            pxSerial->ucTxDescriptorFlags = ucFlags;
+            pxSerial->xTxDescriptorTask = xTaskGetCurrentTaskHandle();
+            pxSerial->usTxDescriptorLength = usLength;
+
+            prvTxStart(pxSerial);
+
+            xReturn = pdPASS;
         }
+    }
+    portEXIT_CRITICAL();
 
-        if(xHigherPriorityTaskWoken)
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xSerialWaitForDescriptor(xComPortHandle pxPort, TickType_t xBlockTime)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+    TimeOut_t xTimeOut;
+    TickType_t xTicksToWait = xBlockTime;
+    uint16_t usRemaining;
+
+    vTaskSetTimeOutState(&xTimeOut);
+
+    /* The notification may also have come from the Rx or Tx ring, so the
+    length is checked again each time this task wakes.  It is two bytes, so
+    is read with interrupts masked. */
+    for(;;)
+    {
+        portENTER_CRITICAL();
         {
-            portYIELD();
+            usRemaining = pxSerial->usTxDescriptorLength;
+        }
+        portEXIT_CRITICAL();
+
+        if(usRemaining == 0)
+        {
+            break;
+        }
+
+        if(xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+        {
+            return pdFALSE;
         }
+
+        (void) ulTaskNotifyTake(pdTRUE, xTicksToWait);
     }
-    portEXIT_CRITICAL();
+
+    return pdTRUE;
 }
+/*-----------------------------------------------------------*/
 
+#if (configSERIAL_USE_STATS == 1)
 
+void vSerialGetStats(xComPortHandle pxPort, SerialStats_t *pxStats, portBASE_TYPE xReset)
+{
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+
+    portENTER_CRITICAL();
+    {
+        *pxStats = pxSerial->xStats;
+
+        if(xReset != pdFALSE)
+        {
+            vPortXFill((xdata void *) &(pxSerial->xStats), 0x00, sizeof(SerialStats_t));
+        }
+    }
+    portEXIT_CRITICAL();
+}
 /*-----------------------------------------------------------*/
 
-portBASE_TYPE xSerialGetChar(xComPortHandle pxPort, signed char *pcRxedChar, TickType_t xBlockTime)
+#endif
+
+#if (configSERIAL_USE_FLOW_CONTROL == 1)
+
+void vSerialFlowControlPoll(void)
 {
-    /* There is only one port supported. */
-    (void) pxPort;
+    uint8_t ucPort;
 
-    /* Get the next character from the buffer.  Return false if no characters
-    are available, or arrive before xBlockTime expires. */
-    if(xQueueReceive(xRxedChars, pcRxedChar, xBlockTime))
+    /* Restart any transmitter that CTS stopped.  prvTxStart() does nothing
+    for a port that has nothing to send, or whose CTS still holds it. */
+    portENTER_CRITICAL();
+    {
+        for(ucPort = 0; ucPort < serNUM_PORTS; ucPort++)
+        {
+            prvTxStart(&xSerialPorts[ ucPort ]);
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+portBASE_TYPE xSerialPutChar(xComPortHandle pxPort, signed char cOutChar, TickType_t xBlockTime)
+{
+    if(uxSerialWrite(pxPort, &cOutChar, 1, xBlockTime) != 0)
     {
         return (portBASE_TYPE) pdTRUE;
     }
@@ -174,35 +1534,142 @@ portBASE_TYPE xSerialGetChar(xComPortHandle pxPort, signed char *pcRxedChar, Tic
 }
 /*-----------------------------------------------------------*/
 
-portBASE_TYPE xSerialPutChar(xComPortHandle pxPort, signed char cOutChar, TickType_t xBlockTime)
+#if (configUSE_ACTIVE_OBJECTS == 1)
+
+void vSerialSetRxActiveObject(xComPortHandle pxPort, ActiveObject_t *pxAO, unsigned char ucSignal)
 {
-    portBASE_TYPE xReturn;
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
 
-    /* There is only one port supported. */
-    (void) pxPort;
+    portENTER_CRITICAL();
+    {
+        pxSerial->pxRxActiveObject = (portXRAM_POINTER ActiveObject_t *) pxAO;
+        pxSerial->ucRxSignal = ucSignal;
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif
+
+unsigned short usSerialGetBaudError(xComPortHandle pxPort)
+{
+    return serPORT(pxPort)->usBaudError;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xSerialLoopbackTest(xComPortHandle pxPort)
+{
+    /* Alternating bits, every bit set and clear, and the single bits at
+    either end of the character, so a wrong divisor shows up as a changed
+    character or a framing error. */
+    static code const uint8_t ucPattern[] = { 0x55, 0xaa, 0x00, 0xff, 0x0f, 0xf0, 0x01, 0x80 };
+    portXRAM_POINTER SerialPort_t *pxSerial = serPORT(pxPort);
+    uint8_t ucIRQBit;
+    uint8_t ucChar;
+    unsigned char ucOriginalSFRPage;
+    portBASE_TYPE xResult = pdPASS;
+
+#if (configSERIAL_USE_UART1 == 1)
+    ucIRQBit = (pxSerial->ucUART != 0) ? serUART1_IRQ_BIT : serUART0_IRQ_BIT;
+#else
+    ucIRQBit = serUART0_IRQ_BIT;
+#endif
 
     portENTER_CRITICAL();
     {
-        if(uxTxEmpty == pdTRUE)
+        /* The pattern cannot be sent while the ISR is still sending. */
+        if((pxSerial->ucTxEmpty == pdFALSE) || (pxSerial->usTxDescriptorLength != 0))
         {
-            UART0_BUF = cOutChar;
-            uxTxEmpty = pdFALSE;
-            UART0_STATE = 0x0F;            
-            xReturn = (portBASE_TYPE) pdTRUE;
+            xResult = pdFAIL;
         }
         else
         {
-            xReturn = xQueueSend(xCharsForTx, &cOutChar, xBlockTime);
+            ucOriginalSFRPage = SFRPAGE;
+            SFRPAGE = 0;
 
-            if(xReturn == (portBASE_TYPE) pdFALSE)
+            /* Poll the UART instead of taking its interrupt. */
+            IEN2 &= ~ucIRQBit;
+
+            for(ucChar = 0; ucChar < sizeof(ucPattern); ucChar++)
             {
-                xReturn = (portBASE_TYPE) pdTRUE;
+                if(prvLoopbackChar(pxSerial->ucUART, ucPattern[ ucChar ]) != pdPASS)
+                {
+                    xResult = pdFAIL;
+                    break;
+                }
             }
+
+            IRCON2 &= ~ucIRQBit;
+            IEN2 |= ucIRQBit;
+
+            SFRPAGE = ucOriginalSFRPage;
         }
     }
     portEXIT_CRITICAL();
 
-    return xReturn;
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvLoopbackChar(uint8_t ucUART, uint8_t ucChar)
+{
+    uint16_t usPolls;
+    uint8_t ucState = 0;
+    uint8_t ucRxed = (uint8_t) ~ucChar;
+
+#if (configSERIAL_USE_UART1 == 1)
+    if(ucUART != 0)
+    {
+        /* Throw away anything left over, then send the character and wait
+        for it to come back. */
+        UART1_STATE = 0x17;
+        UART1_BUF = ucChar;
+        UART1_STATE = 0x0F;
+
+        for(usPolls = serLOOPBACK_POLLS; usPolls != 0; usPolls--)
+        {
+            if(UART1_STATE & 0x08)
+            {
+                ucState = UART1_STATE;
+                ucRxed = UART1_BUF;
+                break;
+            }
+        }
+
+        UART1_STATE = 0x0F;
+        UART1_STATE = 0x17;
+        UART1_STATE = 0x18;
+    }
+    else
+#else
+    (void) ucUART;
+#endif
+    {
+        UART0_STATE = 0x17;
+        UART0_BUF = ucChar;
+        UART0_STATE = 0x0F;
+
+        for(usPolls = serLOOPBACK_POLLS; usPolls != 0; usPolls--)
+        {
+            if(UART0_STATE & 0x08)
+            {
+                ucState = UART0_STATE;
+                ucRxed = UART0_BUF;
+                break;
+            }
+        }
+
+        UART0_STATE = 0x0F;
+        UART0_STATE = 0x17;
+        UART0_STATE = 0x18;
+    }
+
+    if((usPolls == 0) || (ucRxed != ucChar) || ((ucState & (serSTATE_FRAME_ERROR | serSTATE_PARITY_ERROR | serSTATE_OVERRUN)) != 0))
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
@@ -213,7 +1680,3 @@ void vSerialClose(xComPortHandle xPort)
 }
 /*-----------------------------------------------------------*/
 
-
-
-
-
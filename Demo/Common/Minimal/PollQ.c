@@ -82,6 +82,15 @@ static portTASK_FUNCTION_PROTO( vPolledQueueConsumer, pvParameters );
  * errors. */
 static volatile BaseType_t xPollingConsumerCount = pollqINITIAL_VALUE, xPollingProducerCount = pollqINITIAL_VALUE;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* The queue, its storage and the two tasks, placed in XRAM by the linker. */
+    static StaticQueue_t xPolledQueueBuffer;
+    static uint8_t ucPolledQueueStorage[ pollqQUEUE_SIZE * sizeof( uint16_t ) ];
+    static StaticTask_t xConsumerTCB, xProducerTCB;
+    static StackType_t uxConsumerStack[ pollqSTACK_SIZE ], uxProducerStack[ pollqSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartPolledQueueTasks( UBaseType_t uxPriority )
@@ -89,7 +98,11 @@ void vStartPolledQueueTasks( UBaseType_t uxPriority )
     static QueueHandle_t xPolledQueue;
 
     /* Create the queue used by the producer and consumer. */
-    xPolledQueue = xQueueCreate( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ) );
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        xPolledQueue = xQueueCreateStatic( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ), ucPolledQueueStorage, &xPolledQueueBuffer );
+    #else
+        xPolledQueue = xQueueCreate( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ) );
+    #endif
 
     if( xPolledQueue != NULL )
     {
@@ -102,8 +115,13 @@ void vStartPolledQueueTasks( UBaseType_t uxPriority )
         vQueueAddToRegistry( xPolledQueue, "Poll_Test_Queue" );
 
         /* Spawn the producer and consumer. */
-        xTaskCreate( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
-        xTaskCreate( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTaskCreateStatic( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, uxConsumerStack, &xConsumerTCB );
+            xTaskCreateStatic( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, uxProducerStack, &xProducerTCB );
+        #else
+            xTaskCreate( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+            xTaskCreate( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,341 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+/*
+ * Benchmark of the active object dispatcher in active_object.c against one
+ * task per component.
+ *
+ * aotestNUM_COMPONENTS components pass a single token round a ring.  Each
+ * component checks the token carries the hop number it expects, counts the
+ * hop, and passes the token on to the next component.
+ *
+ * With aotestUSE_TASKS set to 0 every component is an active object.  All of
+ * them share the dispatcher task and its one stack, and a hop is an xAOPost()
+ * followed by the next pass of the dispatcher loop.
+ *
+ * With aotestUSE_TASKS set to 1 every component is a task blocked on its own
+ * queue, so a hop is a queue send, a queue receive and a context switch,
+ * which copies the stack of the outgoing and incoming task.
+ *
+ * Exactly one component holds the token at any time, so either build has one
+ * ready benchmark task at the idle priority, and gets the same share of the
+ * processor.  ulAOTestHops counts the hops.  Reading it twice a known number
+ * of ticks apart, from the debugger (its address is in the .map file), gives
+ * the hop rate of each build.
+ *
+ * Separately, when given a serial port, the benchmark binds an active object
+ * to the port's Rx interrupt with vSerialSetRxActiveObject().  Each received
+ * character is then posted straight from the ISR to that object, at a higher
+ * object priority than the ring, without passing through the Rx buffer or a
+ * task.  ulAOTestRxChars counts the characters, and the object's ucDropped
+ * those lost to a full event ring.  The aotestUSE_TASKS build starts the
+ * dispatcher for this object alone; it stays blocked while the line is quiet,
+ * so it does not change the hop rate.
+ *
+ * XRAM per component, from the structure sizes in the large model:
+ *   active object - ActiveObject_t (9 bytes) plus a ring of
+ *                   aotestEVENT_RING_LENGTH events (4 bytes), plus the one
+ *                   shared dispatcher TCB and stack.
+ *   task          - TCB (52 bytes), configMINIMAL_STACK_SIZE stack and a one
+ *                   event queue (44 bytes).
+ */
+
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo program include files. */
+#include "active_object.h"
+#include "serial.h"
+#include "aotest.h"
+
+#ifndef aotestUSE_TASKS
+    #define aotestUSE_TASKS             0
+#endif
+
+#define aotestNUM_COMPONENTS            ( 4 )
+#define aotestSTACK_SIZE                configMINIMAL_STACK_SIZE
+#define aotestEVENT_RING_LENGTH         ( 2 )
+
+/* The signal used by the components, and the one received characters are
+ * posted with. */
+#define aotestSIG_TOKEN                 ( 1 )
+#define aotestSIG_RX_CHAR               ( 2 )
+
+/* The Rx object is served before the ring, so characters are not held up
+ * behind the token. */
+#define aotestRX_PRIORITY               ( aotestNUM_COMPONENTS )
+#define aotestRX_RING_LENGTH            ( 8 )
+
+/* The token never waits for space, as only one is in flight. */
+#define aotestNO_BLOCK                  ( ( TickType_t ) 0 )
+
+typedef struct xAO_TEST_COMPONENT
+{
+#if (aotestUSE_TASKS == 0)
+    ActiveObject_t xAO;                 /* Must be first, see prvComponentDispatch(). */
+    AOEvent_t xEvents[aotestEVENT_RING_LENGTH];
+#else
+    QueueHandle_t xQueue;
+#endif
+    uint8_t ucIndex;
+} AOTestComponent_t;
+
+static AOTestComponent_t xComponents[aotestNUM_COMPONENTS];
+
+/* The object the serial Rx interrupt posts to. */
+static ActiveObject_t xRxAO;
+static AOEvent_t xRxEvents[aotestRX_RING_LENGTH];
+
+/* Number of times the token has been passed on. */
+volatile uint32_t ulAOTestHops = 0;
+
+/* Number of characters the Rx object has been given. */
+volatile uint32_t ulAOTestRxChars = 0;
+
+static uint32_t ulLastHops = 0;
+static BaseType_t xErrorOccurred = pdFALSE;
+
+#if (aotestUSE_TASKS == 0)
+
+/*
+ * Dispatch function shared by every component.
+ */
+static void prvComponentDispatch(ActiveObject_t *pxAO, const AOEvent_t *pxEvent);
+
+#else
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+/* The queues, TCBs and stacks of the component tasks, placed in XRAM by the
+ * linker. */
+static StaticQueue_t xComponentQueueBuffers[aotestNUM_COMPONENTS];
+static AOEvent_t xComponentQueueStorage[aotestNUM_COMPONENTS];
+static StaticTask_t xComponentTCBs[aotestNUM_COMPONENTS];
+static StackType_t uxComponentStacks[aotestNUM_COMPONENTS][aotestSTACK_SIZE];
+#endif
+
+static portTASK_FUNCTION_PROTO(vComponentTask, pvParameters);
+
+#endif
+
+/*
+ * Check and count the token, then pass it to the next component.
+ */
+static void prvTakeToken(AOTestComponent_t *pxComponent, uint8_t ucHop);
+
+/*
+ * Dispatch function of the Rx object.
+ */
+static void prvRxDispatch(ActiveObject_t *pxAO, const AOEvent_t *pxEvent);
+
+/*-----------------------------------------------------------*/
+
+void vStartActiveObjectTest(UBaseType_t uxPriority, xComPortHandle xRxPort)
+{
+    uint8_t ucComponent;
+
+#if (aotestUSE_TASKS == 0)
+    vStartActiveObjects(uxPriority);
+#else
+    if(xRxPort != NULL)
+    {
+        vStartActiveObjects(uxPriority);
+    }
+#endif
+
+    if(xRxPort != NULL)
+    {
+        vAOCreate(&xRxAO, prvRxDispatch, aotestRX_PRIORITY, xRxEvents, aotestRX_RING_LENGTH);
+        vSerialSetRxActiveObject(xRxPort, &xRxAO, aotestSIG_RX_CHAR);
+    }
+
+#if (aotestUSE_TASKS == 0)
+
+    for(ucComponent = 0; ucComponent < aotestNUM_COMPONENTS; ucComponent++)
+    {
+        xComponents[ucComponent].ucIndex = ucComponent;
+        vAOCreate(&(xComponents[ucComponent].xAO), prvComponentDispatch, ucComponent, xComponents[ucComponent].xEvents, aotestEVENT_RING_LENGTH);
+    }
+
+    /* Hand the token to the first component. */
+    (void) xAOPost(&(xComponents[0].xAO), aotestSIG_TOKEN, 0);
+#else
+    AOEvent_t xToken;
+
+    for(ucComponent = 0; ucComponent < aotestNUM_COMPONENTS; ucComponent++)
+    {
+        xComponents[ucComponent].ucIndex = ucComponent;
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+        xComponents[ucComponent].xQueue = xQueueCreateStatic(1, (UBaseType_t) sizeof(AOEvent_t), (uint8_t *) &(xComponentQueueStorage[ucComponent]), &(xComponentQueueBuffers[ucComponent]));
+        xTaskCreateStatic(vComponentTask, "AOTest", aotestSTACK_SIZE, (void *) &(xComponents[ucComponent]), uxPriority, uxComponentStacks[ucComponent], &(xComponentTCBs[ucComponent]));
+#else
+        xComponents[ucComponent].xQueue = xQueueCreate(1, (UBaseType_t) sizeof(AOEvent_t));
+        xTaskCreate(vComponentTask, "AOTest", aotestSTACK_SIZE, (void *) &(xComponents[ucComponent]), uxPriority, (TaskHandle_t *) NULL);
+#endif
+    }
+
+    /* Hand the token to the first component. */
+    xToken.ucSignal = aotestSIG_TOKEN;
+    xToken.ucData = 0;
+    (void) xQueueSend(xComponents[0].xQueue, &xToken, aotestNO_BLOCK);
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvTakeToken(AOTestComponent_t *pxComponent, uint8_t ucHop)
+{
+    uint8_t ucNext;
+    BaseType_t xPassed;
+#if (aotestUSE_TASKS == 1)
+    AOEvent_t xToken;
+#endif
+
+    /* Only one component runs at a time, so the count is not protected
+     * against other components - only against the check in
+     * xAreActiveObjectTestsStillRunning(). */
+    if(ucHop != (uint8_t) ulAOTestHops)
+    {
+        xErrorOccurred = pdTRUE;
+    }
+
+    portENTER_CRITICAL();
+    {
+        ulAOTestHops++;
+    }
+    portEXIT_CRITICAL();
+
+    ucNext = pxComponent->ucIndex + 1;
+    if(ucNext >= aotestNUM_COMPONENTS)
+    {
+        ucNext = 0;
+    }
+
+#if (aotestUSE_TASKS == 0)
+    xPassed = xAOPost(&(xComponents[ucNext].xAO), aotestSIG_TOKEN, ucHop + 1);
+#else
+    xToken.ucSignal = aotestSIG_TOKEN;
+    xToken.ucData = ucHop + 1;
+    xPassed = xQueueSend(xComponents[ucNext].xQueue, &xToken, aotestNO_BLOCK);
+#endif
+
+    if(xPassed != pdPASS)
+    {
+        xErrorOccurred = pdTRUE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRxDispatch(ActiveObject_t *pxAO, const AOEvent_t *pxEvent)
+{
+    (void) pxAO;
+
+    if(pxEvent->ucSignal == aotestSIG_RX_CHAR)
+    {
+        ulAOTestRxChars++;
+    }
+    else
+    {
+        xErrorOccurred = pdTRUE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if (aotestUSE_TASKS == 0)
+
+static void prvComponentDispatch(ActiveObject_t *pxAO, const AOEvent_t *pxEvent)
+{
+    if(pxEvent->ucSignal == aotestSIG_TOKEN)
+    {
+        prvTakeToken((AOTestComponent_t *) pxAO, pxEvent->ucData);
+    }
+    else
+    {
+        xErrorOccurred = pdTRUE;
+    }
+}
+
+#else
+
+static portTASK_FUNCTION(vComponentTask, pvParameters)
+{
+    AOTestComponent_t *pxComponent = (AOTestComponent_t *) pvParameters;
+    AOEvent_t xEvent;
+
+    for(; ;)
+    {
+        if(xQueueReceive(pxComponent->xQueue, &xEvent, portMAX_DELAY) == pdPASS)
+        {
+            if(xEvent.ucSignal == aotestSIG_TOKEN)
+            {
+                prvTakeToken(pxComponent, xEvent.ucData);
+            }
+            else
+            {
+                xErrorOccurred = pdTRUE;
+            }
+        }
+    }
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+BaseType_t xAreActiveObjectTestsStillRunning(void)
+{
+    BaseType_t xReturn = pdTRUE;
+    uint32_t ulHops;
+
+    portENTER_CRITICAL();
+    {
+        ulHops = ulAOTestHops;
+    }
+    portEXIT_CRITICAL();
+
+    /* The token must have moved since the last call. */
+    if((ulHops == ulLastHops) || (xErrorOccurred != pdFALSE))
+    {
+        xReturn = pdFALSE;
+    }
+
+#if (aotestUSE_TASKS == 0)
+    {
+        uint8_t ucComponent;
+
+        for(ucComponent = 0; ucComponent < aotestNUM_COMPONENTS; ucComponent++)
+        {
+            if(xComponents[ucComponent].xAO.ucDropped != 0)
+            {
+                xReturn = pdFALSE;
+            }
+        }
+    }
+#endif
+
+    ulLastHops = ulHops;
+
+    return xReturn;
+}
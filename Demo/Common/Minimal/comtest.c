@@ -54,6 +54,9 @@
  * transmitted so neither the Tx or Rx queue should ever hold more than a few
  * characters.
  *
+ * When comBENCHMARK_MODE is 1 the two tasks are replaced by a single benchmark
+ * task, see the description above prvBenchmarkRun() below.
+ *
  */
 
 /* Scheduler include files. */
@@ -65,6 +68,7 @@
 #include "serial.h"
 #include "comtest.h"
 #include "partest.h"
+#include "idlecount.h"
 
 #define comSTACK_SIZE                  configMINIMAL_STACK_SIZE
 #define comTX_LED_OFFSET               ( 0 )
@@ -91,14 +95,100 @@
 #define comBUFFER_LEN                  ( ( UBaseType_t ) ( comLAST_BYTE - comFIRST_BYTE ) + ( UBaseType_t ) 1 )
 #define comINITIAL_RX_COUNT_VALUE      ( 0 )
 
+/* Stream a PRBS through the loopback to measure throughput and CPU cost
+ * instead of running the Tx and Rx tasks. */
+#ifndef comBENCHMARK_MODE
+    #define comBENCHMARK_MODE          0
+#endif
+
+#if ( comBENCHMARK_MODE == 1 )
+
+/* The baud rates and frame sizes the benchmark steps through.  Every frame
+ * size is run at every baud rate. */
+    #ifndef comBENCH_BAUD_RATES
+        #define comBENCH_BAUD_RATES    9600UL, 57600UL, 115200UL, 250000UL, 500000UL
+    #endif
+
+    #ifndef comBENCH_FRAME_SIZES
+        #define comBENCH_FRAME_SIZES    8U, 64U, 512U
+    #endif
+
+/* Length of the idle baseline and of the measurement at each setting. */
+    #ifndef comBENCH_RUN_TICKS
+        #define comBENCH_RUN_TICKS     ( ( TickType_t ) 2000 / portTICK_PERIOD_MS )
+    #endif
+
+/* Characters generated and written to the Tx buffer at a time, and the Rx
+ * trigger level, so the task wakes once per comBENCH_CHUNK characters rather
+ * than once per character. */
+    #define comBENCH_CHUNK             ( 8U )
+
+/* A frame that stops arriving for this long has lost characters. */
+    #define comBENCH_RX_TIMEOUT        ( ( TickType_t ) 100 / portTICK_PERIOD_MS )
+
+/* Seed of the x^15 + x^14 + 1 PRBS.  Any non-zero 15 bit value will do. */
+    #define comBENCH_PRBS_SEED         ( ( uint16_t ) 0x7fff )
+
+/* Result of one baud rate and frame size.  ulBytesPerSecond counts only the
+ * characters of complete frames.  usCPUPermille is the share of the processor
+ * the ISR and the benchmark task took from the idle task, in tenths of a
+ * percent.  A frame that came back short adds the missing characters to
+ * usDroppedBytes and is not checked for bit errors, as the characters after
+ * the gap no longer line up with the PRBS. */
+    typedef struct xCOM_BENCH_RESULT
+    {
+        uint32_t ulBaud;
+        uint16_t usFrameSize;
+        uint32_t ulBytesPerSecond;
+        uint16_t usBitErrors;
+        uint16_t usDroppedBytes;
+        uint16_t usCPUPermille;
+        #if ( configSERIAL_USE_STATS == 1 )
+            uint16_t usHardwareOverruns; /* UART overruns seen by the driver. */
+            uint16_t usRxDropped;        /* Characters the driver's Rx buffer had no room for. */
+        #endif
+    } ComBenchResult_t;
+
+    static const uint32_t ulBenchBaudRates[] = { comBENCH_BAUD_RATES };
+    static const uint16_t usBenchFrameSizes[] = { comBENCH_FRAME_SIZES };
+
+    #define comBENCH_NUM_BAUD_RATES    ( sizeof( ulBenchBaudRates ) / sizeof( ulBenchBaudRates[ 0 ] ) )
+    #define comBENCH_NUM_FRAME_SIZES   ( sizeof( usBenchFrameSizes ) / sizeof( usBenchFrameSizes[ 0 ] ) )
+
+/* One result per baud rate and frame size, in the order they are run, for
+ * reading from the debugger (the address is in the .map file).
+ * ulComBenchPasses counts the passes through every setting. */
+    ComBenchResult_t xComBenchResults[ comBENCH_NUM_BAUD_RATES * comBENCH_NUM_FRAME_SIZES ];
+    volatile uint32_t ulComBenchPasses = 0;
+
+/* The Tx and Rx sides of the PRBS. */
+    static uint16_t usTxPRBS = comBENCH_PRBS_SEED;
+    static uint16_t usRxPRBS = comBENCH_PRBS_SEED;
+
+/* Characters generated but not yet accepted by the Tx buffer. */
+    static uint8_t ucTxChunk[ comBENCH_CHUNK ];
+
+/* The benchmark task. */
+    static portTASK_FUNCTION_PROTO( vComBenchTask, pvParameters );
+
+/* Measure one baud rate and frame size into *pxResult. */
+    static void prvBenchmarkRun( ComBenchResult_t * pxResult );
+
+/* Return the next eight bits of the PRBS held in *pusState. */
+    static uint8_t prvPRBSNextByte( uint16_t * pusState );
+#endif /* comBENCHMARK_MODE */
+
 /* Handle to the com port used by both tasks. */
 static xComPortHandle xPort = NULL;
 
+#if ( comBENCHMARK_MODE == 0 )
+
 /* The transmit task as described at the top of the file. */
-static portTASK_FUNCTION_PROTO( vComTxTask, pvParameters );
+    static portTASK_FUNCTION_PROTO( vComTxTask, pvParameters );
 
 /* The receive task as described at the top of the file. */
-static portTASK_FUNCTION_PROTO( vComRxTask, pvParameters );
+    static portTASK_FUNCTION_PROTO( vComRxTask, pvParameters );
+#endif
 
 /* The LED that should be toggled by the Rx and Tx tasks.  The Rx task will
  * toggle LED ( uxBaseLED + comRX_LED_OFFSET).  The Tx task will toggle LED
@@ -110,6 +200,22 @@ static UBaseType_t uxBaseLED = 0;
  * time the sequence is incorrect the the variable will stop being incremented. */
 static volatile UBaseType_t uxRxLoops = comINITIAL_RX_COUNT_VALUE;
 
+/* Bytes taken from the serial port in one call to uxSerialGetChars(). */
+static signed char cRxBuffer[ comBUFFER_LEN ];
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* The TCBs and stacks of the Rx and Tx tasks, placed in XRAM by the linker.
+ * The benchmark task uses those of the Rx task. */
+    static StaticTask_t xComRxTCB;
+    static StackType_t uxComRxStack[ comSTACK_SIZE ];
+
+    #if ( comBENCHMARK_MODE == 0 )
+        static StaticTask_t xComTxTCB;
+        static StackType_t uxComTxStack[ comSTACK_SIZE ];
+    #endif
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vAltStartComTestTasks( UBaseType_t uxPriority,
@@ -120,12 +226,27 @@ void vAltStartComTestTasks( UBaseType_t uxPriority,
     uxBaseLED = uxLED;
     xSerialPortInitMinimal( ulBaudRate, comBUFFER_LEN );
 
-    /* The Tx task is spawned with a lower priority than the Rx task. */
-    xTaskCreate( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
-    xTaskCreate( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+    #if ( comBENCHMARK_MODE == 1 )
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTaskCreateStatic( vComBenchTask, "COMBn", comSTACK_SIZE, NULL, uxPriority, uxComRxStack, &xComRxTCB );
+        #else
+            xTaskCreate( vComBenchTask, "COMBn", comSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+        #endif
+    #else
+        /* The Tx task is spawned with a lower priority than the Rx task. */
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTaskCreateStatic( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, uxComTxStack, &xComTxTCB );
+            xTaskCreateStatic( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, uxComRxStack, &xComRxTCB );
+        #else
+            xTaskCreate( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
+            xTaskCreate( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+        #endif
+    #endif /* comBENCHMARK_MODE */
 }
 /*-----------------------------------------------------------*/
 
+#if ( comBENCHMARK_MODE == 0 )
+
 static portTASK_FUNCTION( vComTxTask, pvParameters )
 {
     char cByteToSend;
@@ -172,6 +293,7 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
 {
     signed char cExpectedByte, cByteRxed;
     BaseType_t xResyncRequired = pdFALSE, xErrorOccurred = pdFALSE;
+    UBaseType_t uxBytesRxed, uxByte;
 
     /* Just to stop compiler warnings. */
     ( void ) pvParameters;
@@ -179,22 +301,31 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
     for( ; ; )
     {
         /* We expect to receive the characters from comFIRST_BYTE to
-         * comLAST_BYTE in an incrementing order.  Loop to receive each byte. */
-        for( cExpectedByte = comFIRST_BYTE; cExpectedByte <= comLAST_BYTE; cExpectedByte++ )
+         * comLAST_BYTE in an incrementing order.  Block until at least one
+         * byte is available, then take as many as have arrived in one call,
+         * never asking for more than the remainder of the sequence. */
+        cExpectedByte = comFIRST_BYTE;
+
+        while( ( cExpectedByte <= comLAST_BYTE ) && ( xResyncRequired == pdFALSE ) )
         {
-            /* Block on the queue that contains received bytes until a byte is
-             * available. */
-            if( xSerialGetChar( xPort, &cByteRxed, comRX_BLOCK_TIME ) )
+            uxBytesRxed = uxSerialGetChars( xPort, cRxBuffer, ( UBaseType_t ) ( comLAST_BYTE - cExpectedByte ) + ( UBaseType_t ) 1, 1, comRX_BLOCK_TIME );
+
+            for( uxByte = 0; uxByte < uxBytesRxed; uxByte++ )
             {
+                cByteRxed = cRxBuffer[ uxByte ];
+
                 /* Was this the byte we were expecting?  If so, toggle the LED,
                 * otherwise we are out on sync and should break out of the loop
                 * until the expected character sequence is about to restart. */
                 if( cByteRxed == cExpectedByte )
                 {
                     vParTestToggleLED( uxBaseLED + comRX_LED_OFFSET );
+                    cExpectedByte++;
                 }
                 else
                 {
+                    /* Resynchronise from the last byte of the batch. */
+                    cByteRxed = cRxBuffer[ uxBytesRxed - 1 ];
                     xResyncRequired = pdTRUE;
                     break; /*lint !e960 Non-switch break allowed. */
                 }
@@ -241,6 +372,8 @@ static portTASK_FUNCTION( vComRxTask, pvParameters )
 } /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
 /*-----------------------------------------------------------*/
 
+#endif /* comBENCHMARK_MODE */
+
 BaseType_t xAreComTestTasksStillRunning( void )
 {
     BaseType_t xReturn;
@@ -251,6 +384,14 @@ BaseType_t xAreComTestTasksStillRunning( void )
     if( uxRxLoops == comINITIAL_RX_COUNT_VALUE )
     {
         xReturn = pdFALSE;
+
+        #if ( comBENCHMARK_MODE == 1 )
+            /* No frames are sent while the baseline is measured. */
+            if( xIdleCountInBaseline() != pdFALSE )
+            {
+                xReturn = pdTRUE;
+            }
+        #endif
     }
     else
     {
@@ -263,3 +404,225 @@ BaseType_t xAreComTestTasksStillRunning( void )
 
     return xReturn;
 }
+/*-----------------------------------------------------------*/
+
+#if ( comBENCHMARK_MODE == 1 )
+
+    static portTASK_FUNCTION( vComBenchTask, pvParameters )
+    {
+        UBaseType_t uxBaud, uxFrameSize;
+        ComBenchResult_t * pxResult;
+
+        /* Just to stop compiler warnings. */
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            pxResult = xComBenchResults;
+
+            for( uxBaud = 0; uxBaud < comBENCH_NUM_BAUD_RATES; uxBaud++ )
+            {
+                for( uxFrameSize = 0; uxFrameSize < comBENCH_NUM_FRAME_SIZES; uxFrameSize++ )
+                {
+                    pxResult->ulBaud = ulBenchBaudRates[ uxBaud ];
+                    pxResult->usFrameSize = usBenchFrameSizes[ uxFrameSize ];
+                    prvBenchmarkRun( pxResult );
+                    pxResult++;
+                }
+            }
+
+            ulComBenchPasses++;
+        }
+    } /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
+/*-----------------------------------------------------------*/
+
+/*
+ * The benchmark task runs every frame size at every baud rate in turn.  For
+ * each it first blocks for comBENCH_RUN_TICKS to count how often the idle hook
+ * runs with the port quiet, which is the baseline.  It then streams frames of
+ * PRBS characters round the loopback for another comBENCH_RUN_TICKS, writing
+ * each frame comBENCH_CHUNK characters at a time and checking the characters
+ * that come back against a second copy of the PRBS.  A frame is finished
+ * before the next is started, so a lost character cannot push the following
+ * frames out of line.
+ *
+ * The idle hook count during the stream, against the baseline, gives the
+ * share of the processor taken by the serial ISR and the benchmark task
+ * together.  Any other load cancels out as long as it is the same in both
+ * periods.  The cost per character (mostly the ISR) and per frame (mostly the
+ * task) can be separated by comparing the results for different frame sizes
+ * at the same baud rate.
+ */
+    static void prvBenchmarkRun( ComBenchResult_t * pxResult )
+    {
+        TickType_t xStartTime;
+        uint32_t ulBytes;
+        uint16_t usTxed, usRxed, usChunk, usChunkSent, usBitErrors, usDropped;
+        UBaseType_t uxReceived, uxByte, uxWanted;
+        uint8_t ucDifference;
+
+        #if ( configSERIAL_USE_STATS == 1 )
+            SerialStats_t xStats;
+        #endif
+
+        pxResult->ulBytesPerSecond = 0;
+        pxResult->usBitErrors = 0;
+        pxResult->usDroppedBytes = 0;
+        pxResult->usCPUPermille = 0;
+
+        if( xSerialPortInitMinimal( pxResult->ulBaud, comBUFFER_LEN ) == NULL )
+        {
+            /* The UART cannot reach this rate closely enough. */
+            return;
+        }
+
+        vSerialSetRxTriggerLevel( xPort, comBENCH_CHUNK );
+
+        /* Baseline, with the port quiet. */
+        vIdleCountStartBaseline();
+        vTaskDelay( comBENCH_RUN_TICKS );
+        vIdleCountStartRun();
+        uxRxLoops = ( UBaseType_t ) 1;
+
+        ulBytes = 0;
+        usBitErrors = 0;
+        usDropped = 0;
+        xStartTime = xTaskGetTickCount();
+
+        while( ( TickType_t ) ( xTaskGetTickCount() - xStartTime ) < comBENCH_RUN_TICKS )
+        {
+            usTxed = 0;
+            usRxed = 0;
+            usChunk = 0;
+            usChunkSent = 0;
+
+            while( usRxed < pxResult->usFrameSize )
+            {
+                /* Keep the Tx buffer topped up. */
+                while( usTxed < pxResult->usFrameSize )
+                {
+                    if( usChunkSent == usChunk )
+                    {
+                        usChunk = pxResult->usFrameSize - usTxed;
+
+                        if( usChunk > comBENCH_CHUNK )
+                        {
+                            usChunk = comBENCH_CHUNK;
+                        }
+
+                        for( usChunkSent = 0; usChunkSent < usChunk; usChunkSent++ )
+                        {
+                            ucTxChunk[ usChunkSent ] = prvPRBSNextByte( &usTxPRBS );
+                        }
+
+                        usChunkSent = 0;
+                    }
+
+                    uxReceived = uxSerialWrite( xPort, &( ucTxChunk[ usChunkSent ] ), ( UBaseType_t ) ( usChunk - usChunkSent ), comNO_BLOCK );
+                    usChunkSent += ( uint16_t ) uxReceived;
+                    usTxed += ( uint16_t ) uxReceived;
+
+                    if( usChunkSent != usChunk )
+                    {
+                        /* The Tx buffer is full. */
+                        break;
+                    }
+                }
+
+                /* Then wait for the next chunk to come back. */
+                uxWanted = ( UBaseType_t ) ( pxResult->usFrameSize - usRxed );
+
+                if( uxWanted > comBUFFER_LEN )
+                {
+                    uxWanted = comBUFFER_LEN;
+                }
+
+                uxReceived = uxSerialRead( xPort, cRxBuffer, uxWanted, comBENCH_RX_TIMEOUT );
+
+                if( uxReceived == 0 )
+                {
+                    break;
+                }
+
+                for( uxByte = 0; uxByte < uxReceived; uxByte++ )
+                {
+                    ucDifference = ( uint8_t ) cRxBuffer[ uxByte ] ^ prvPRBSNextByte( &usRxPRBS );
+
+                    while( ucDifference != 0 )
+                    {
+                        usBitErrors++;
+                        ucDifference &= ( uint8_t ) ( ucDifference - 1 );
+                    }
+                }
+
+                usRxed += ( uint16_t ) uxReceived;
+            }
+
+            if( usRxed == pxResult->usFrameSize )
+            {
+                ulBytes += usRxed;
+            }
+            else
+            {
+                /* Characters were lost.  Let anything still in flight arrive
+                 * and throw it away, and bring both halves of the PRBS to the
+                 * start of the next frame.  Bit errors already counted for
+                 * this frame stay counted. */
+                usDropped += ( uint16_t ) ( pxResult->usFrameSize - usRxed );
+
+                while( usTxed < pxResult->usFrameSize )
+                {
+                    ( void ) prvPRBSNextByte( &usTxPRBS );
+                    usTxed++;
+                }
+
+                while( usRxed < pxResult->usFrameSize )
+                {
+                    ( void ) prvPRBSNextByte( &usRxPRBS );
+                    usRxed++;
+                }
+
+                vTaskDelay( comBENCH_RX_TIMEOUT );
+
+                while( uxSerialRead( xPort, cRxBuffer, comBUFFER_LEN, comNO_BLOCK ) != 0 )
+                {
+                }
+            }
+
+            /* Only shows the task is still running, so set rather than
+             * incremented, which could wrap back to zero. */
+            uxRxLoops = ( UBaseType_t ) 1;
+        }
+
+        pxResult->usCPUPermille = usIdleCountCPUPermille();
+        pxResult->ulBytesPerSecond = ( ulBytes * configTICK_RATE_HZ ) / comBENCH_RUN_TICKS;
+        pxResult->usBitErrors = usBitErrors;
+        pxResult->usDroppedBytes = usDropped;
+
+        #if ( configSERIAL_USE_STATS == 1 )
+            vSerialGetStats( xPort, &xStats, pdTRUE );
+            pxResult->usHardwareOverruns = xStats.usHardwareOverruns;
+            pxResult->usRxDropped = xStats.usRxDropped;
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+    static uint8_t prvPRBSNextByte( uint16_t * pusState )
+    {
+        uint16_t usState = *pusState;
+        uint8_t ucBit, ucByte = 0;
+
+        for( ucBit = 0; ucBit < 8; ucBit++ )
+        {
+            /* x^15 + x^14 + 1. */
+            usState = ( uint16_t ) ( ( usState << 1 ) | ( ( ( usState >> 14 ) ^ ( usState >> 13 ) ) & 0x01U ) );
+            ucByte = ( uint8_t ) ( ( ucByte << 1 ) | ( usState & 0x01U ) );
+        }
+
+        *pusState = usState & 0x7fffU;
+
+        return ucByte;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* comBENCHMARK_MODE */
@@ -55,8 +55,9 @@
 /* Demo application includes. */
 #include "crhook.h"
 
-/* The number of 'hook' co-routines that are to be created. */
-#define hookNUM_HOOK_CO_ROUTINES      ( 4 )
+/* The number of 'hook' co-routines that are to be created.  One, as the XRAM
+ * heap does not have room for more, each co-routine needs two queues. */
+#define hookNUM_HOOK_CO_ROUTINES      ( 1 )
 
 /* The number of times the tick hook should be called before a character is
  * posted to the 'hook' co-routines. */
@@ -59,6 +59,13 @@ static volatile UBaseType_t uxFlashTaskNumber = 0;
 /* The task that is created three times. */
 static portTASK_FUNCTION_PROTO( vLEDFlashTask, pvParameters );
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* The TCBs and stacks of the flash tasks, placed in XRAM by the linker. */
+    static StaticTask_t xLEDFlashTCBs[ ledNUMBER_OF_LEDS ];
+    static StackType_t uxLEDFlashStacks[ ledNUMBER_OF_LEDS ][ ledSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartLEDFlashTasks( UBaseType_t uxPriority )
@@ -69,7 +76,11 @@ void vStartLEDFlashTasks( UBaseType_t uxPriority )
     for( xLEDTask = 0; xLEDTask < ledNUMBER_OF_LEDS; ++xLEDTask )
     {
         /* Spawn the task. */
-        xTaskCreate( vLEDFlashTask, "LEDx", ledSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTaskCreateStatic( vLEDFlashTask, "LEDx", ledSTACK_SIZE, NULL, uxPriority, uxLEDFlashStacks[ xLEDTask ], &( xLEDFlashTCBs[ xLEDTask ] ) );
+        #else
+            xTaskCreate( vLEDFlashTask, "LEDx", ledSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
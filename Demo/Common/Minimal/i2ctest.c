@@ -54,6 +54,10 @@
  * transmitted so neither the Tx or Rx queue should ever hold more than a few
  * characters.
  *
+ * When i2cBENCHMARK_MODE is 1 the master task measures the processor time
+ * per byte of the two ways of driving the bus instead, see the description
+ * above prvBenchmarkRun() below.
+ *
  */
 
 /* Scheduler include files. */
@@ -64,10 +68,12 @@
 
 /* Demo program include files. */
 #include "i2c_slave.h"
+#include "queue_batch.h"
 #include "i2c_master.h"
 #include "i2ctest.h"
 #include "serial.h"
 #include "partest.h"
+#include "idlecount.h"
 
 #define i2cSTACK_SIZE                     configMINIMAL_STACK_SIZE
 #define i2cDATA_LED_OFFSET               ( 0 )
@@ -90,13 +96,62 @@
 #define i2cBUFFER_LEN                  ( ( UBaseType_t ) ( i2cLAST_BYTE - i2cFIRST_BYTE ) + ( UBaseType_t ) 1 )
 #define i2cINITIAL_RX_COUNT_VALUE      ( 0 )
 
-SemaphoreHandle_t xSlaveReceivedSemaphore;
-SemaphoreHandle_t xSlaveTransmidSemaphore;
+/* Compare the timer driven and busy-wait master transfers instead of running
+ * the master test loop. */
+#ifndef i2cBENCHMARK_MODE
+    #define i2cBENCHMARK_MODE          0
+#endif
+
+#if (i2cBENCHMARK_MODE == 1)
+
+#if (configI2C_MASTER_USE_TIMER == 0)
+    #error The I2C benchmark needs configI2C_MASTER_USE_TIMER set to 1
+#endif
+
+/* Length of the idle baseline and of the measurement of each method. */
+#ifndef i2cBENCH_RUN_TICKS
+    #define i2cBENCH_RUN_TICKS         ( ( TickType_t ) 2000 / portTICK_PERIOD_MS )
+#endif
+
+/* Index of each method in xI2CBenchResults[]. */
+#define i2cBENCH_TIMER                 ( 0 )
+#define i2cBENCH_POLLED                ( 1 )
+
+/* Result of one method.  ulBytesPerSecond counts the data bytes written to
+ * the slave.  usCPUPermille is the share of the processor the transfers took
+ * from the idle task, in tenths of a percent, and usCPUMicrosecondsPerByte is
+ * the processor time that comes to for each byte.  Both include the slave
+ * interrupt and tasks, which do the same work either way. */
+typedef struct xI2C_BENCH_RESULT
+{
+    uint32_t ulBytesPerSecond;
+    uint16_t usCPUPermille;
+    uint16_t usCPUMicrosecondsPerByte;
+} I2CBenchResult_t;
+
+/* For reading from the debugger (the address is in the .map file).
+ * ulI2CBenchPasses counts the passes through both methods. */
+I2CBenchResult_t xI2CBenchResults[ 2 ];
+volatile uint32_t ulI2CBenchPasses = 0;
+
+/* Measure one method into *pxResult. */
+static void prvBenchmarkRun(UBaseType_t uxMethod, I2CBenchResult_t *pxResult);
+#endif /* i2cBENCHMARK_MODE */
+
+/* Given from the I2C interrupt, so kept in the pdata page with the driver
+ * state. */
+portWARM_DATA SemaphoreHandle_t xSlaveReceivedSemaphore;
+portWARM_DATA SemaphoreHandle_t xSlaveTransmidSemaphore;
 
 uint8_t I2CTempBuffer[i2cBUFFER_LEN];
 
-extern QueueHandle_t xSlaveReceivedQueue;
-extern QueueHandle_t xSlaveTransmidQueue;
+/* The sequence posted to the slave transmit queue, and the bytes drained
+ * from the slave receive queue, one batch at a time. */
+static uint8_t ucSlaveTransmidBuffer[i2cBUFFER_LEN];
+static uint8_t ucSlaveReceivedBuffer[i2cBUFFER_LEN];
+
+extern portWARM_DATA QueueHandle_t xSlaveReceivedQueue;
+extern portWARM_DATA QueueHandle_t xSlaveTransmidQueue;
 
 /* The transmit task as described at the top of the file. */
 static portTASK_FUNCTION_PROTO(vSlaveReceived, pvParameters);
@@ -110,6 +165,18 @@ static UBaseType_t uxBaseLED = 0;
 
 static volatile UBaseType_t uxRxLoops = i2cINITIAL_RX_COUNT_VALUE;
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+
+/* The semaphores, TCBs and stacks of the I2C tasks, placed in XRAM by the
+ * linker. */
+static StaticSemaphore_t xSlaveReceivedSemaphoreBuffer;
+static StaticSemaphore_t xSlaveTransmidSemaphoreBuffer;
+static StaticTask_t xSlaveReceivedTCB, xSlaveTransmidTCB, xMasterProccessTCB;
+static StackType_t uxSlaveReceivedStack[i2cSTACK_SIZE];
+static StackType_t uxSlaveTransmidStack[i2cSTACK_SIZE];
+static StackType_t uxMasterProccessStack[i2cSTACK_SIZE];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartI2CTestTasks(UBaseType_t uxPriority,
@@ -122,6 +189,19 @@ void vStartI2CTestTasks(UBaseType_t uxPriority,
 
     xI2CMasterInitMinimal();
 
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+    /* Created given, as vSemaphoreCreateBinary() does. */
+    xSlaveTransmidSemaphore = xSemaphoreCreateBinaryStatic(&xSlaveTransmidSemaphoreBuffer);
+    xSemaphoreGive(xSlaveTransmidSemaphore);
+
+    xSlaveReceivedSemaphore = xSemaphoreCreateBinaryStatic(&xSlaveReceivedSemaphoreBuffer);
+    xSemaphoreGive(xSlaveReceivedSemaphore);
+
+    /* The Tx task is spawned with a lower priority than the Rx task. */
+    xTaskCreateStatic(vSlaveReceived, "I2C_RCV", i2cSTACK_SIZE, NULL, uxPriority, uxSlaveReceivedStack, &xSlaveReceivedTCB);
+    xTaskCreateStatic(vSlaveTransmid, "I2C_TRD", i2cSTACK_SIZE, NULL, uxPriority, uxSlaveTransmidStack, &xSlaveTransmidTCB);
+    xTaskCreateStatic(vMasterProccess, "MasterTst", i2cSTACK_SIZE, NULL, uxPriority - 1, uxMasterProccessStack, &xMasterProccessTCB);
+#else
     vSemaphoreCreateBinary(xSlaveTransmidSemaphore);
 
     vSemaphoreCreateBinary(xSlaveReceivedSemaphore);
@@ -130,6 +210,7 @@ void vStartI2CTestTasks(UBaseType_t uxPriority,
     xTaskCreate(vSlaveReceived, "I2C_RCV", i2cSTACK_SIZE, NULL, uxPriority, (TaskHandle_t *) NULL);
     xTaskCreate(vSlaveTransmid, "I2C_TRD", i2cSTACK_SIZE, NULL, uxPriority, (TaskHandle_t *) NULL);
     xTaskCreate(vMasterProccess, "MasterTst", i2cSTACK_SIZE, NULL, uxPriority - 1, (TaskHandle_t *) NULL);
+#endif
 }
 
 /*-----------------------------------------------------------*/
@@ -140,15 +221,18 @@ static portTASK_FUNCTION(vSlaveTransmid, pvParameters)
 
     (void) pvParameters;
 
+    for(TempByte = i2cFIRST_BYTE; TempByte <= i2cLAST_BYTE; TempByte++)
+    {
+        ucSlaveTransmidBuffer[TempByte - i2cFIRST_BYTE] = TempByte;
+    }
+
     for(; ;)
     {
         if(xSemaphoreTake(xSlaveTransmidSemaphore, portMAX_DELAY) == pdPASS)
         {
-            for(TempByte = i2cFIRST_BYTE; TempByte <= i2cLAST_BYTE; TempByte++)
-            {
-                xQueueSend(xSlaveTransmidQueue, &TempByte, 0);
-                vParTestToggleLED(uxBaseLED + i2cDATA_LED_OFFSET);
-            }
+            /* Post the whole sequence in one batch. */
+            xQueueSendMultiple(xSlaveTransmidQueue, ucSlaveTransmidBuffer, i2cBUFFER_LEN, i2cNO_BLOCK);
+            vParTestToggleLED(uxBaseLED + i2cDATA_LED_OFFSET);
         }
     }
 }
@@ -157,7 +241,7 @@ static portTASK_FUNCTION(vSlaveTransmid, pvParameters)
 
 static portTASK_FUNCTION(vSlaveReceived, pvParameters)
 {
-    uint8_t TempByte;
+    UBaseType_t uxBytesReceived, uxByte;
     uint8_t ExpectedByte;
     BaseType_t xErrorOccurred = pdFALSE;
 
@@ -167,16 +251,23 @@ static portTASK_FUNCTION(vSlaveReceived, pvParameters)
     {
         if(xSemaphoreTake(xSlaveReceivedSemaphore, portMAX_DELAY) == pdPASS)
         {
-            for(ExpectedByte = i2cFIRST_BYTE; ExpectedByte <= i2cLAST_BYTE; ExpectedByte++)
+            /* Drain everything the slave ISR has queued in one batch. */
+            uxBytesReceived = xQueueReceiveMultiple(xSlaveReceivedQueue, ucSlaveReceivedBuffer, i2cBUFFER_LEN, 0, i2cNO_BLOCK);
+
+            ExpectedByte = i2cFIRST_BYTE;
+
+            for(uxByte = 0; uxByte < uxBytesReceived; uxByte++)
             {
-                if(xQueueReceive(xSlaveReceivedQueue, &TempByte, 0) == (portBASE_TYPE) pdTRUE)
+                if(ucSlaveReceivedBuffer[uxByte] != ExpectedByte)
                 {
-                    if(TempByte != ExpectedByte)
-                    {
-                        xErrorOccurred++;
-                    }
-                    vParTestToggleLED(uxBaseLED + i2cDATA_LED_OFFSET);
+                    xErrorOccurred++;
                 }
+                ExpectedByte++;
+            }
+
+            if(uxBytesReceived > 0)
+            {
+                vParTestToggleLED(uxBaseLED + i2cDATA_LED_OFFSET);
             }
         }
         if(xErrorOccurred < i2cTOTAL_PERMISSIBLE_ERRORS)
@@ -196,6 +287,24 @@ static portTASK_FUNCTION(vSlaveReceived, pvParameters)
 
 static portTASK_FUNCTION(vMasterProccess, pvParameters)
 {
+#if (i2cBENCHMARK_MODE == 1)
+    uint8_t ucByte;
+
+    (void) pvParameters;
+
+    /* The sequence the slave receive task checks for. */
+    for(ucByte = 0; ucByte < i2cBUFFER_LEN; ucByte++)
+    {
+        I2CTempBuffer[ucByte] = i2cFIRST_BYTE + ucByte;
+    }
+
+    for(; ;)
+    {
+        prvBenchmarkRun(i2cBENCH_TIMER, &xI2CBenchResults[i2cBENCH_TIMER]);
+        prvBenchmarkRun(i2cBENCH_POLLED, &xI2CBenchResults[i2cBENCH_POLLED]);
+        ulI2CBenchPasses++;
+    }
+#else
     TickType_t xTimeToWait;
 
     (void) pvParameters;
@@ -237,10 +346,69 @@ static portTASK_FUNCTION(vMasterProccess, pvParameters)
 
         vTaskDelay(xTimeToWait);
     }
+#endif /* i2cBENCHMARK_MODE */
+}
+
+/*-----------------------------------------------------------*/
+
+#if (i2cBENCHMARK_MODE == 1)
+
+/*
+ * Each method is measured as in the comtest.c benchmark.  The master task
+ * first blocks for i2cBENCH_RUN_TICKS to count how often the idle hook runs
+ * with the bus quiet, which is the baseline.  It then writes the test
+ * sequence to the slave back to back for another i2cBENCH_RUN_TICKS, and the
+ * idle hook count against the baseline gives the share of the processor the
+ * transfers took.  The busy-wait transfers hold the processor for as long as
+ * the bus is busy, so theirs is close to all of it.  The timer driven ones
+ * only take it for the interrupt at each SCL edge, leaving the rest to the
+ * tasks of lower priority.
+ */
+static void prvBenchmarkRun(UBaseType_t uxMethod, I2CBenchResult_t *pxResult)
+{
+    TickType_t xStartTime;
+    uint32_t ulBytes;
+
+    pxResult->ulBytesPerSecond = 0;
+    pxResult->usCPUPermille = 0;
+    pxResult->usCPUMicrosecondsPerByte = 0;
+
+    /* Baseline, with the bus quiet. */
+    vIdleCountStartBaseline();
+    vTaskDelay(i2cBENCH_RUN_TICKS);
+    vIdleCountStartRun();
+
+    ulBytes = 0;
+    xStartTime = xTaskGetTickCount();
+
+    while((TickType_t) (xTaskGetTickCount() - xStartTime) < i2cBENCH_RUN_TICKS)
+    {
+        if(uxMethod == i2cBENCH_TIMER)
+        {
+            vI2CMasterWriteData(0xC0, I2CTempBuffer, i2cBUFFER_LEN);
+        }
+        else
+        {
+            vI2CMasterWriteDataPolled(0xC0, I2CTempBuffer, i2cBUFFER_LEN);
+        }
+
+        ulBytes += i2cBUFFER_LEN;
+    }
+
+    pxResult->usCPUPermille = usIdleCountCPUPermille();
+    pxResult->ulBytesPerSecond = (ulBytes * configTICK_RATE_HZ) / i2cBENCH_RUN_TICKS;
+
+    /* The share of the run, in microseconds, spread over the bytes. */
+    if(ulBytes != 0)
+    {
+        pxResult->usCPUMicrosecondsPerByte = (uint16_t) (((uint32_t) pxResult->usCPUPermille * i2cBENCH_RUN_TICKS * portTICK_PERIOD_MS) / ulBytes);
+    }
 }
 
 /*-----------------------------------------------------------*/
 
+#endif /* i2cBENCHMARK_MODE */
+
 BaseType_t xAreI2CTestTasksStillRunning(void)
 {
     BaseType_t xReturn;
@@ -251,6 +419,14 @@ BaseType_t xAreI2CTestTasksStillRunning(void)
     if(uxRxLoops == i2cINITIAL_RX_COUNT_VALUE)
     {
         xReturn = pdFALSE;
+
+#if (i2cBENCHMARK_MODE == 1)
+        /* Nothing is written while the baseline is measured. */
+        if(xIdleCountInBaseline() != pdFALSE)
+        {
+            xReturn = pdTRUE;
+        }
+#endif
     }
     else
     {
@@ -0,0 +1,117 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+/*
+ * The idle pass counter shared by the comtest.c and i2ctest.c benchmarks, see
+ * idlecount.h.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "idlecount.h"
+
+/* Incremented by vIdleCountHook(). */
+static volatile uint32_t ulIdleCount = 0;
+
+/* The count at the start of the current period, and the passes counted over
+ * the baseline. */
+static uint32_t ulIdleStart = 0;
+static uint32_t ulBaseline = 0;
+
+static volatile BaseType_t xInBaseline = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vIdleCountHook( void )
+{
+    /* The count is read by a task of a higher priority, which could
+     * otherwise see it half updated. */
+    portENTER_CRITICAL();
+    {
+        ulIdleCount++;
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIdleCountStartBaseline( void )
+{
+    xInBaseline = pdTRUE;
+
+    portENTER_CRITICAL();
+    {
+        ulIdleStart = ulIdleCount;
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIdleCountStartRun( void )
+{
+    portENTER_CRITICAL();
+    {
+        ulBaseline = ulIdleCount - ulIdleStart;
+        ulIdleStart = ulIdleCount;
+    }
+    portEXIT_CRITICAL();
+
+    xInBaseline = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usIdleCountCPUPermille( void )
+{
+    uint32_t ulIdleRun, ulScaledBaseline;
+    uint16_t usPermille = 0;
+
+    portENTER_CRITICAL();
+    {
+        ulIdleRun = ulIdleCount - ulIdleStart;
+    }
+    portEXIT_CRITICAL();
+
+    /* Scale the baseline down rather than the run count up, so the
+     * arithmetic cannot overflow. */
+    ulScaledBaseline = ulBaseline / 1000UL;
+
+    if( ( ulScaledBaseline != 0 ) && ( ( ulIdleRun / ulScaledBaseline ) < 1000UL ) )
+    {
+        usPermille = ( uint16_t ) ( 1000UL - ( ulIdleRun / ulScaledBaseline ) );
+    }
+
+    return usPermille;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIdleCountInBaseline( void )
+{
+    return xInBaseline;
+}
+/*-----------------------------------------------------------*/
@@ -63,6 +63,13 @@ static portTASK_FUNCTION_PROTO( vCompeteingIntMathTask, pvParameters );
  * is called. */
 static BaseType_t xTaskCheck[ intgNUMBER_OF_TASKS ] = { ( BaseType_t ) pdFALSE };
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* The TCBs and stacks of the calculation tasks, placed in XRAM by the linker. */
+    static StaticTask_t xIntMathTCBs[ intgNUMBER_OF_TASKS ];
+    static StackType_t uxIntMathStacks[ intgNUMBER_OF_TASKS ][ intgSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartIntegerMathTasks( UBaseType_t uxPriority )
@@ -71,7 +78,11 @@ void vStartIntegerMathTasks( UBaseType_t uxPriority )
 
     for( sTask = 0; sTask < intgNUMBER_OF_TASKS; sTask++ )
     {
-        xTaskCreate( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, ( TaskHandle_t * ) NULL );
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTaskCreateStatic( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, uxIntMathStacks[ sTask ], &( xIntMathTCBs[ sTask ] ) );
+        #else
+            xTaskCreate( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, ( TaskHandle_t * ) NULL );
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
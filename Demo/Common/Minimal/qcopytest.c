@@ -0,0 +1,190 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+/*
+ * Measures how fast queue.c copies items in and out of a queue, to compare
+ * builds with configUSE_PORT_QUEUE_COPY set to 1 and to 0 (see portmacro.h).
+ *
+ * A single task creates a queue of each item size in usBenchItemSizes[] in
+ * turn, and for qcopyRUN_TICKS sends an item to it and receives it back
+ * again as fast as it can, without blocking.  Each round trip is two copies.
+ * The item is first taken from and returned to a static variable, which is
+ * in XRAM like the queue storage, and then a local variable, which is on the
+ * IRAM stack as are the items the serial and I2C ISRs queue.  The task then
+ * blocks for qcopyPAUSE_TICKS so the tasks of lower priority get to run.
+ *
+ * The task runs at the priority of the other demo tasks and shares the
+ * processor with them, so the results only compare builds running the same
+ * demo, not the copy routines on their own.
+ *
+ * The copy is measured here rather than with the serial loopback benchmark
+ * (comBENCHMARK_MODE in comtest.c) because the serial driver no longer queues
+ * its characters: serial.c moves them through byte rings of its own, so the
+ * loopback rate does not depend on queue.c's copy at all.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo program include files. */
+#include "qcopytest.h"
+
+#define qcopySTACK_SIZE                configMINIMAL_STACK_SIZE
+
+/* Length of each measurement, and of the pause after it. */
+#ifndef qcopyRUN_TICKS
+    #define qcopyRUN_TICKS             ( ( TickType_t ) 500 / portTICK_PERIOD_MS )
+#endif
+#define qcopyPAUSE_TICKS               ( ( TickType_t ) 500 / portTICK_PERIOD_MS )
+
+/* The item sizes measured, no larger than qcopyMAX_ITEM_SIZE.  1, 2 and 4
+ * byte items take the single access copy routines of port.c, larger ones its
+ * block copy. */
+#ifndef qcopyITEM_SIZES
+    #define qcopyITEM_SIZES            1U, 2U, 4U, 8U
+#endif
+#define qcopyMAX_ITEM_SIZE             ( 8U )
+
+/* Round trips between each check of the tick count. */
+#define qcopyBATCH                     ( 16U )
+
+/* Result of one item size.  Copies are counted per second, two per round
+ * trip. */
+typedef struct xQCOPY_BENCH_RESULT
+{
+    uint8_t ucItemSize;
+    uint32_t ulXRAMCopiesPerSecond; /* Item in a static variable. */
+    uint32_t ulIRAMCopiesPerSecond; /* Item in a local variable. */
+} QueueCopyBenchResult_t;
+
+static const uint8_t ucBenchItemSizes[] = { qcopyITEM_SIZES };
+
+#define qcopyNUM_ITEM_SIZES            ( sizeof( ucBenchItemSizes ) / sizeof( ucBenchItemSizes[ 0 ] ) )
+
+/* One result per item size, for reading from the debugger (the address is in
+ * the .map file).  ulQueueCopyBenchPasses counts the passes through every
+ * size. */
+QueueCopyBenchResult_t xQueueCopyBenchResults[ qcopyNUM_ITEM_SIZES ];
+volatile uint32_t ulQueueCopyBenchPasses = 0;
+
+/* The XRAM item. */
+static uint8_t ucXRAMItem[ qcopyMAX_ITEM_SIZE ];
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    static StaticTask_t xQueueCopyTCB;
+    static StackType_t uxQueueCopyStack[ qcopySTACK_SIZE ];
+    static StaticQueue_t xQueueCopyQueueBuffer;
+    static uint8_t ucQueueCopyStorage[ qcopyMAX_ITEM_SIZE ];
+#endif
+
+/* The benchmark task. */
+static portTASK_FUNCTION_PROTO( vQueueCopyTask, pvParameters );
+
+/* Send and receive the item at pvItem through xQueue for qcopyRUN_TICKS and
+ * return the number of copies per second. */
+static uint32_t prvMeasure( QueueHandle_t xQueue,
+                            void * pvItem );
+
+/*-----------------------------------------------------------*/
+
+void vStartQueueCopyBenchmark( UBaseType_t uxPriority )
+{
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        xTaskCreateStatic( vQueueCopyTask, "QCopy", qcopySTACK_SIZE, NULL, uxPriority, uxQueueCopyStack, &xQueueCopyTCB );
+    #else
+        xTaskCreate( vQueueCopyTask, "QCopy", qcopySTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vQueueCopyTask, pvParameters )
+{
+    UBaseType_t uxSize;
+    QueueHandle_t xQueue;
+    uint8_t ucIRAMItem[ qcopyMAX_ITEM_SIZE ];
+
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        for( uxSize = 0; uxSize < qcopyNUM_ITEM_SIZES; uxSize++ )
+        {
+            xQueueCopyBenchResults[ uxSize ].ucItemSize = ucBenchItemSizes[ uxSize ];
+
+            /* One queue at a time, so the benchmark only needs the heap or
+             * static memory of the largest. */
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xQueue = xQueueCreateStatic( 1, ucBenchItemSizes[ uxSize ], ucQueueCopyStorage, &xQueueCopyQueueBuffer );
+            #else
+                xQueue = xQueueCreate( 1, ucBenchItemSizes[ uxSize ] );
+            #endif
+
+            if( xQueue != NULL )
+            {
+                xQueueCopyBenchResults[ uxSize ].ulXRAMCopiesPerSecond = prvMeasure( xQueue, ucXRAMItem );
+                vTaskDelay( qcopyPAUSE_TICKS );
+
+                xQueueCopyBenchResults[ uxSize ].ulIRAMCopiesPerSecond = prvMeasure( xQueue, ucIRAMItem );
+                vTaskDelay( qcopyPAUSE_TICKS );
+
+                vQueueDelete( xQueue );
+            }
+        }
+
+        ulQueueCopyBenchPasses++;
+    }
+} /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasure( QueueHandle_t xQueue,
+                            void * pvItem )
+{
+    TickType_t xStartTime;
+    uint32_t ulRoundTrips = 0;
+    UBaseType_t uxBatch;
+
+    /* Start on a tick boundary. */
+    vTaskDelay( 1 );
+    xStartTime = xTaskGetTickCount();
+
+    while( ( TickType_t ) ( xTaskGetTickCount() - xStartTime ) < qcopyRUN_TICKS )
+    {
+        for( uxBatch = 0; uxBatch < qcopyBATCH; uxBatch++ )
+        {
+            ( void ) xQueueSend( xQueue, pvItem, 0 );
+            ( void ) xQueueReceive( xQueue, pvItem, 0 );
+        }
+
+        ulRoundTrips += qcopyBATCH;
+    }
+
+    return ( ulRoundTrips * 2UL * configTICK_RATE_HZ ) / qcopyRUN_TICKS;
+}
+/*-----------------------------------------------------------*/
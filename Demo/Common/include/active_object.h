@@ -0,0 +1,98 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+#ifndef ACTIVE_OBJECT_H
+#define ACTIVE_OBJECT_H
+
+/*
+ * Active objects are event handlers that share a single task, and so a single
+ * XRAM stack.  Each object owns a small ring of events and a dispatch
+ * function.  The dispatcher task takes the oldest event of the highest
+ * priority object that has one and runs its dispatch function to completion
+ * before looking again, so handlers never preempt each other and no context
+ * switch is needed between events.  A dispatch function must therefore not
+ * block.
+ *
+ * An object is usually embedded as the first member of the structure that
+ * holds the state of its component, so the dispatch function can cast pxAO
+ * back to that structure.
+ *
+ * Events can be posted from tasks, from dispatch functions and from ISRs.
+ * serial.c and i2c_slave.c can post their received bytes straight to an
+ * object, see vSerialSetRxActiveObject() and vI2CSlaveSetRxActiveObject().
+ */
+
+/* Number of object priorities.  Each object must have its own priority. */
+#define aoMAX_PRIORITIES        ( 8 )
+
+/* An event: a signal number and one byte of data. */
+typedef struct xAO_EVENT
+{
+    uint8_t ucSignal;
+    uint8_t ucData;
+} AOEvent_t;
+
+struct xACTIVE_OBJECT;
+
+typedef void (*AODispatchFunction_t)(struct xACTIVE_OBJECT *pxAO, const AOEvent_t *pxEvent);
+
+typedef struct xACTIVE_OBJECT
+{
+    AODispatchFunction_t pxDispatch;        /* Called once for every event. */
+    portXRAM_POINTER AOEvent_t *pxEvents;   /* Event ring, ucLength entries. */
+    uint8_t ucLength;
+    uint8_t ucHead;                         /* Index of the oldest event. */
+    uint8_t ucCount;                        /* Number of events in the ring. */
+    uint8_t ucPriority;                     /* 0 (lowest) to aoMAX_PRIORITIES - 1. */
+    uint8_t ucDropped;                      /* Events lost because the ring was full. */
+} ActiveObject_t;
+
+/*
+ * Create the task that dispatches the events of every object, at task
+ * priority uxPriority.
+ */
+void vStartActiveObjects(UBaseType_t uxPriority);
+
+/*
+ * Register pxAO with the dispatcher.  pxEventStorage must be in XRAM and hold
+ * ucLength events.  Can be called before or after vStartActiveObjects().
+ */
+void vAOCreate(ActiveObject_t *pxAO, AODispatchFunction_t pxDispatch, uint8_t ucPriority, AOEvent_t *pxEventStorage, uint8_t ucLength);
+
+/*
+ * Post an event to the back of the ring of pxAO.  Never blocks - returns
+ * pdFAIL, and counts the event in ucDropped, if the ring is full.
+ */
+BaseType_t xAOPost(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData);
+
+/*
+ * Interrupt safe version of xAOPost().  *pxHigherPriorityTaskWoken is set to
+ * pdTRUE if the dispatcher task was woken and has a higher priority than the
+ * interrupted task.
+ */
+BaseType_t xAOPostFromISR(ActiveObject_t *pxAO, uint8_t ucSignal, uint8_t ucData, BaseType_t *pxHigherPriorityTaskWoken);
+
+#endif /* ifndef ACTIVE_OBJECT_H */
@@ -0,0 +1,104 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+/*
+ * Deferred binary logging.  A log call stores a short record in an XRAM ring
+ * instead of formatting text: the 16 bit ID of its message, the tick count and
+ * the raw bytes of up to three integer arguments.  A task streams the ring out
+ * of a serial port, and Tools/binlog.py turns the records back into text on
+ * the host.
+ *
+ * The format string is only ever seen by the preprocessor, which throws it
+ * away, and by Tools/binlog.py, which collects every
+ * binlogPRINTn( NAME, "format", ... ) in the sources into the generated
+ * binlog_ids.h (binlogID_NAME for each message) and a table for the host.  It
+ * never reaches the compiler, so takes no code memory.
+ *
+ * NAME must be a C identifier and the same NAME must always be used with the
+ * same format.  Arguments are integers of 1 to 4 bytes, cast to uint32_t on
+ * the way in and stored with the size of their own type, so the format must
+ * match that size as it would for printf(): %c or %hh for one byte, plain %d,
+ * %u or %x for a two byte int and %l for four bytes.
+ *
+ * The log calls can be made from tasks and from ISRs.  A record that does not
+ * fit in the ring is dropped and counted, and the count is logged when there
+ * is room again.
+ */
+
+#if( configUSE_BINARY_LOG == 1 )
+
+    #include "binlog_ids.h"
+
+    /* IDs used by the log itself.  Tools/binlog.py numbers the messages it
+    finds from binlogFIRST_USER_ID. */
+    #define binlogID_TABLE              ( 0 )   /* One two byte argument, binlogTABLE_HASH. */
+    #define binlogID_DROPPED            ( 1 )   /* One two byte argument, records dropped. */
+    #define binlogFIRST_USER_ID         ( 2 )
+
+    /* Start of every record on the wire, see Tools/binlog.py. */
+    #define binlogSYNC                  ( 0x7e )
+
+    /* Size of an argument less one, in the two bits that vBinLogWrite()
+    expects for it. */
+    #define binlogSIZE( x )             ( ( uint8_t ) ( ( sizeof( x ) - 1 ) & 0x03 ) )
+
+    #define binlogPRINT0( xName, pcFormat ) \
+        vBinLogWrite( binlogID_##xName, 0x00, 0, 0, 0 )
+    #define binlogPRINT1( xName, pcFormat, a ) \
+        vBinLogWrite( binlogID_##xName, ( uint8_t ) ( 0x40 | binlogSIZE( a ) ), ( uint32_t ) ( a ), 0, 0 )
+    #define binlogPRINT2( xName, pcFormat, a, b ) \
+        vBinLogWrite( binlogID_##xName, ( uint8_t ) ( 0x80 | binlogSIZE( a ) | ( binlogSIZE( b ) << 2 ) ), ( uint32_t ) ( a ), ( uint32_t ) ( b ), 0 )
+    #define binlogPRINT3( xName, pcFormat, a, b, c ) \
+        vBinLogWrite( binlogID_##xName, ( uint8_t ) ( 0xc0 | binlogSIZE( a ) | ( binlogSIZE( b ) << 2 ) | ( binlogSIZE( c ) << 4 ) ), ( uint32_t ) ( a ), ( uint32_t ) ( b ), ( uint32_t ) ( c ) )
+
+    /*
+     * Store a record for message usID.  Bits 6 and 7 of ucSizes hold the
+     * number of arguments and each pair of bits below them the size less one
+     * of an argument, first argument in bits 0 and 1.  Use the binlogPRINTn()
+     * macros rather than calling this directly.
+     */
+    void vBinLogWrite( uint16_t usID, uint8_t ucSizes, uint32_t ulArg1, uint32_t ulArg2, uint32_t ulArg3 );
+
+    /*
+     * Create the task that streams the log out of pxPort, at priority
+     * uxPriority.  Nothing else may transmit on pxPort.
+     */
+    void vStartBinLogTask( UBaseType_t uxPriority, xComPortHandle pxPort );
+
+#else
+
+    #define binlogPRINT0( xName, pcFormat )
+    #define binlogPRINT1( xName, pcFormat, a )
+    #define binlogPRINT2( xName, pcFormat, a, b )
+    #define binlogPRINT3( xName, pcFormat, a, b, c )
+
+#endif /* configUSE_BINARY_LOG */
+
+#endif /* ifndef BINLOG_H */
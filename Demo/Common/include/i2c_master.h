@@ -43,9 +43,24 @@
 #define NACK    1
 #define ACK     0
 
-void xI2CMasterInitMinimal( void );
-void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData);
-void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData);
-void vI2CMasterClose( void );
+void xI2CMasterInitMinimal( void ) portREENTRANT;
+
+/* With configI2C_MASTER_USE_TIMER set to 1 the bus is clocked by the timer 1
+interrupt and the calling task blocks until the transfer is complete.
+Otherwise these are the Polled versions below. */
+void vI2CMasterWriteData(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData) portREENTRANT;
+void vI2CMasterReadData(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData) portREENTRANT;
+
+/* The calling task clocks the bus itself, with busy-wait delays. */
+void vI2CMasterWriteDataPolled(uint8_t deviceAddr, uint8_t *dataSource, uint8_t lengthOfData) portREENTRANT;
+void vI2CMasterReadDataPolled(uint8_t deviceAddr, uint8_t *target, uint8_t lengthOfData) portREENTRANT;
+
+void vI2CMasterClose( void ) portREENTRANT;
+
+#if( configI2C_MASTER_USE_TIMER == 1 )
+	/* Set up timer 1 for the timer driven transfers of i2c_master_timer.c,
+	called by xI2CMasterInitMinimal(). */
+	void vI2CMasterTimerInit( void ) portREENTRANT;
+#endif
 
 #endif /* ifndef I2C_MASTER_H */
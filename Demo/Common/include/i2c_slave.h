@@ -30,4 +30,14 @@
 void xI2CSlaveInitMinimal(unsigned portBASE_TYPE uxQueueLength);
 void vI2CSlaveClose( void );
 
+#if( configUSE_ACTIVE_OBJECTS == 1 )
+
+/* Post each byte written by the bus master to pxAO as an event with signal
+ucSignal, instead of queuing it on xSlaveReceivedQueue.  Pass NULL to go back
+to the queue.  See active_object.h. */
+struct xACTIVE_OBJECT;
+void vI2CSlaveSetRxActiveObject(struct xACTIVE_OBJECT *pxAO, uint8_t ucSignal);
+
+#endif
+
 #endif /* ifndef I2C_SLAVE_H */
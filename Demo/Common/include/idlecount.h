@@ -0,0 +1,58 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+#ifndef IDLE_COUNT_H
+#define IDLE_COUNT_H
+
+/*
+ * Processor time measured by counting the passes of the idle task, as used by
+ * the comtest.c and i2ctest.c benchmarks.  vIdleCountHook() must be called
+ * from vApplicationIdleHook().  Only one benchmark may measure at a time.
+ *
+ * A measurement counts the idle passes over a baseline, with the load under
+ * test stopped, and then over a run of the same length with it running:
+ *
+ *     vIdleCountStartBaseline();
+ *     vTaskDelay( xRunTicks );
+ *     vIdleCountStartRun();
+ *     ... apply the load for xRunTicks ...
+ *     usPermille = usIdleCountCPUPermille();
+ *
+ * The result is the share of the processor the load took from the idle task,
+ * in tenths of a percent.  Any other load cancels out as long as it is the
+ * same in both periods.
+ */
+void vIdleCountHook( void );
+void vIdleCountStartBaseline( void );
+void vIdleCountStartRun( void );
+uint16_t usIdleCountCPUPermille( void );
+
+/* pdTRUE between vIdleCountStartBaseline() and vIdleCountStartRun(), when a
+ * benchmark does no work its check function would otherwise miss. */
+BaseType_t xIdleCountInBaseline( void );
+
+#endif /* IDLE_COUNT_H */
@@ -0,0 +1,54 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+#ifndef QUEUE_BATCH_H
+#define QUEUE_BATCH_H
+
+/*
+ * Move up to uxMaxItems items out of xQueue into pvBuffer.  The calling task
+ * blocks for up to xTicksToWait until uxMinItems items have been received,
+ * then takes whatever else is already queued, up to uxMaxItems, with the
+ * scheduler suspended.  Returns the number of items written to pvBuffer.
+ */
+UBaseType_t xQueueReceiveMultiple(QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxItems, UBaseType_t uxMinItems, TickType_t xTicksToWait);
+
+/*
+ * Post up to uxItems items from pvItems to the back of xQueue, blocking for
+ * up to xTicksToWait in total while the queue is full.  Returns the number of
+ * items posted.
+ */
+UBaseType_t xQueueSendMultiple(QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxItems, TickType_t xTicksToWait);
+
+/*
+ * Interrupt safe versions of the above, which never block.
+ * *pxHigherPriorityTaskWoken is set once for the whole batch, so the ISR
+ * requests at most one context switch.
+ */
+UBaseType_t xQueueReceiveMultipleFromISR(QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxItems, BaseType_t *pxHigherPriorityTaskWoken);
+UBaseType_t xQueueSendMultipleFromISR(QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxItems, BaseType_t *pxHigherPriorityTaskWoken);
+
+#endif /* ifndef QUEUE_BATCH_H */
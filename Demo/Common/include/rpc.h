@@ -0,0 +1,110 @@
+/*
+ * FreeRTOS V202112.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://aws.amazon.com/freertos
+ *
+ */
+
+
+#ifndef RPC_H
+#define RPC_H
+
+/*
+ * Binary request/response protocol over a serial port.
+ *
+ * Every frame is COBS encoded, so the only zero byte on the wire is the one
+ * that ends it.  Decoded, a request is
+ *
+ *     sequence number, command ID, payload, CRC16
+ *
+ * and its response is
+ *
+ *     the same sequence number, status, payload, CRC16
+ *
+ * with the CRC16 (CCITT, initial value 0xffff) taken over everything before
+ * it and sent least significant byte first.  Requests are handled in the
+ * order they arrive, so a host can send several before the first response
+ * comes back and match them up by sequence number, provided the requests in
+ * flight fit in the serial driver's Rx buffer.  Frames with a bad CRC or bad
+ * encoding get no response, as their sequence number cannot be trusted.
+ *
+ * The command ID indexes a table of RpcCommand_t in code memory that the
+ * application passes to vStartRpcTask().  A handler is given the request
+ * payload where it was received and writes its response payload straight
+ * into the outgoing frame, so neither is copied.  Tools/rpc_client.py is the
+ * host side.
+ */
+
+/* Response status values.  Handlers return rpcSTATUS_OK or a value of their
+own from rpcSTATUS_FIRST_USER up. */
+#define rpcSTATUS_OK                ( 0x00 )
+#define rpcSTATUS_UNKNOWN_COMMAND   ( 0x01 )
+#define rpcSTATUS_BAD_LENGTH        ( 0x02 )
+#define rpcSTATUS_FIRST_USER        ( 0x10 )
+
+/* Largest decoded frame, including the sequence number, command ID or status
+and CRC. */
+#ifndef configRPC_FRAME_SIZE
+    #define configRPC_FRAME_SIZE    ( 64 )
+#endif
+
+/* Bytes of a decoded frame that are not payload. */
+#define rpcFRAME_OVERHEAD           ( 4 )
+
+/* Largest request or response payload. */
+#define rpcMAX_PAYLOAD              ( configRPC_FRAME_SIZE - rpcFRAME_OVERHEAD )
+
+/*
+ * Handle one request.  ucRequestLength bytes of payload start at pucRequest.
+ * Write up to rpcMAX_PAYLOAD bytes of response to pucResponse, set
+ * *pucResponseLength to the number written and return the status.  Runs in
+ * the RPC task, which handles nothing else until it returns.
+ */
+typedef uint8_t (*RpcHandler_t)(const uint8_t *pucRequest, uint8_t ucRequestLength, uint8_t *pucResponse, uint8_t *pucResponseLength);
+
+typedef struct xRPC_COMMAND
+{
+    RpcHandler_t pxHandler;         /* NULL for an unused command ID. */
+    uint8_t ucMinLength;            /* Shortest request payload accepted. */
+    uint8_t ucMaxLength;            /* Longest request payload accepted. */
+} RpcCommand_t;
+
+/*
+ * Create the task that serves requests arriving on pxPort, at priority
+ * uxPriority.  pxCommands is indexed by command ID and has ucCommands
+ * entries.
+ */
+void vStartRpcTask(UBaseType_t uxPriority, xComPortHandle pxPort, code const RpcCommand_t *pxCommands, uint8_t ucCommands);
+
+/*
+ * Number of frames thrown away because of a bad CRC, bad encoding or because
+ * they were too long.
+ */
+uint16_t usRpcGetFrameErrors(void);
+
+/*
+ * CRC16 (CCITT, table driven) of ucLength bytes at pucData, starting from
+ * usCRC.  Start from 0xffff.
+ */
+uint16_t usRpcCRC16(uint16_t usCRC, const uint8_t *pucData, uint8_t ucLength);
+
+#endif /* ifndef RPC_H */
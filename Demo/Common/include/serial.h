@@ -82,9 +82,32 @@ typedef enum
     ser19200,
     ser38400,
     ser57600,
-    ser115200
+    ser115200,
+    ser230400,
+    ser250000,
+    ser460800,
+    ser500000,
+    ser921600,
+    ser1000000
 } eBaud;
 
+/* Baud rate arithmetic for a UART that divides ulClockHz by 16 times an
+ * integer divisor.  All of these are constant expressions that can be used in
+ * #if, provided the arguments are plain unsuffixed or UL constants.
+ * serialBAUD_DIVISOR() rounds to the nearest divisor, serialBAUD_ACTUAL() is
+ * the rate that divisor gives (zero if the rate is out of reach), and
+ * serialBAUD_ERROR_PERMILLE() is the size of the difference from ulBaud in
+ * tenths of a percent. */
+#define serialBAUD_DIVISOR( ulClockHz, ulBaud ) \
+    ( ( ( ulClockHz ) + ( 8UL * ( ulBaud ) ) ) / ( 16UL * ( ulBaud ) ) )
+#define serialBAUD_ACTUAL( ulClockHz, ulBaud )                                   \
+    ( ( serialBAUD_DIVISOR( ulClockHz, ulBaud ) == 0UL ) ? 0UL :                  \
+      ( ( ulClockHz ) / ( 16UL * serialBAUD_DIVISOR( ulClockHz, ulBaud ) ) ) )
+#define serialBAUD_ERROR_PERMILLE( ulClockHz, ulBaud )                                        \
+    ( ( ( serialBAUD_ACTUAL( ulClockHz, ulBaud ) > ( ulBaud ) ) ?                              \
+        ( serialBAUD_ACTUAL( ulClockHz, ulBaud ) - ( ulBaud ) ) :                              \
+        ( ( ulBaud ) - serialBAUD_ACTUAL( ulClockHz, ulBaud ) ) ) * 1000UL / ( ulBaud ) )
+
 xComPortHandle xSerialPortInitMinimal( unsigned long ulWantedBaud,
                                        unsigned portBASE_TYPE uxQueueLength );
 xComPortHandle xSerialPortInit( eCOMPort ePort,
@@ -102,7 +125,139 @@ void vSerialPutString( xComPortHandle pxPort,
 /*signed*/portBASE_TYPE xSerialPutChar( xComPortHandle pxPort,
                                      signed char cOutChar,
                                      TickType_t xBlockTime );
+unsigned portBASE_TYPE uxSerialGetChars( xComPortHandle pxPort,
+                                         signed char * pcRxedChars,
+                                         unsigned portBASE_TYPE uxMaxChars,
+                                         unsigned portBASE_TYPE uxMinChars,
+                                         TickType_t xBlockTime );
+
+/* Block transfers.  uxSerialRead() waits for up to xBlockTime until the Rx
+ * trigger level (or uxMaxChars, if smaller) is buffered, then returns every
+ * buffered character up to uxMaxChars.  uxSerialWrite() returns the number of
+ * characters that fitted in the Tx buffer before xBlockTime expired.  A task
+ * blocked in either call waits on its task notification. */
+unsigned portBASE_TYPE uxSerialRead( xComPortHandle pxPort,
+                                     void * pvBuffer,
+                                     unsigned portBASE_TYPE uxMaxChars,
+                                     TickType_t xBlockTime );
+unsigned portBASE_TYPE uxSerialWrite( xComPortHandle pxPort,
+                                      const void * pvData,
+                                      unsigned portBASE_TYPE uxLength,
+                                      TickType_t xBlockTime );
+void vSerialSetRxTriggerLevel( xComPortHandle pxPort,
+                               unsigned portBASE_TYPE uxLevel );
+
+/* Zero copy transmit.  xSerialWriteDescriptor() queues usLength characters to
+ * be sent straight from pvData by the Tx ISR, after anything already in the Tx
+ * buffer, and returns pdFAIL if a descriptor is already in flight.  pvData is
+ * in XRAM unless ucFlags includes serDESCRIPTOR_CODE.  The buffer must not be
+ * changed until the calling task has been notified that the last character
+ * was sent, which xSerialWaitForDescriptor() waits for. */
+#define serDESCRIPTOR_XRAM    ( 0x00 )
+#define serDESCRIPTOR_CODE    ( 0x01 )
+
+portBASE_TYPE xSerialWriteDescriptor( xComPortHandle pxPort,
+                                      const void * pvData,
+                                      unsigned short usLength,
+                                      unsigned char ucFlags );
+portBASE_TYPE xSerialWaitForDescriptor( xComPortHandle pxPort,
+                                        TickType_t xBlockTime );
 portBASE_TYPE xSerialWaitForSemaphore( xComPortHandle xPort );
+
+/* Error of the baud rate pxPort was set up with, in tenths of a percent. */
+unsigned short usSerialGetBaudError( xComPortHandle pxPort );
+
+/* Send a calibration pattern on pxPort with its Tx wired back to its Rx, as
+ * the COM test already requires, and return pdPASS if every character came
+ * back intact.  The port's interrupt is masked and the UART polled while the
+ * pattern is sent, so the Tx buffer must be empty and nothing else may use the
+ * port until it returns. */
+portBASE_TYPE xSerialLoopbackTest( xComPortHandle pxPort );
+
+#if ( configSERIAL_USE_STATS == 1 )
+
+/* Per-port counters.  The counts wrap; the peaks are the highest ring fill
+ * seen since the counters were last reset. */
+    typedef struct xSERIAL_STATS
+    {
+        uint16_t usRxChars;          /* Characters stored in the Rx ring. */
+        uint16_t usTxChars;          /* Characters loaded into the UART. */
+        uint16_t usHardwareOverruns; /* UART overrun flags seen. */
+        uint16_t usFramingErrors;    /* UART framing error flags seen. */
+        uint16_t usParityErrors;     /* UART parity error flags seen. */
+        uint16_t usRxDropped;        /* Characters lost because the Rx ring was full. */
+        uint16_t usTxFull;           /* Writes that found the Tx ring full. */
+        uint16_t usCTSStalls;        /* Times CTS held back a character. */
+        uint8_t ucRxPeak;            /* Highest Rx ring fill. */
+        uint8_t ucTxPeak;            /* Highest Tx ring fill. */
+    } SerialStats_t;
+
+/* Copy the counters of pxPort to *pxStats, and clear them if xReset is
+ * pdTRUE. */
+    void vSerialGetStats( xComPortHandle pxPort,
+                          SerialStats_t * pxStats,
+                          portBASE_TYPE xReset );
+#endif
+
+#if ( configSERIAL_USE_FLOW_CONTROL == 1 )
+
+/* Restart transmitters that were held back by CTS.  Call periodically, for
+ * example from vApplicationTickHook(). */
+    void vSerialFlowControlPoll( void );
+#endif
+
+#if ( configSERIAL_USE_FRAME_MODE == 1 )
+
+/* Frame mode.  Once vSerialSetFrameMode() is given a non-zero gap, received
+ * characters are collected into a frame buffer instead of the Rx buffer, and a
+ * silence of uxGapBitTimes bit times (39 for Modbus RTU's 3.5 characters of 11
+ * bits) ends the frame.  uxSerialReceiveFrame() then wakes once per frame,
+ * sets *ppucFrame to the buffer and returns the frame length, or zero if no
+ * frame arrived within xBlockTime.  The buffer belongs to the caller until
+ * vSerialReleaseFrame(); frames that arrive before then, or that overflow the
+ * buffer, are dropped and counted by uxSerialGetFrameErrors(). */
+    void vSerialSetFrameMode( xComPortHandle pxPort,
+                              unsigned portBASE_TYPE uxGapBitTimes );
+    unsigned portBASE_TYPE uxSerialReceiveFrame( xComPortHandle pxPort,
+                                                 uint8_t ** ppucFrame,
+                                                 TickType_t xBlockTime );
+    void vSerialReleaseFrame( xComPortHandle pxPort );
+    unsigned portBASE_TYPE uxSerialGetFrameErrors( xComPortHandle pxPort );
+#endif
+
+#if ( configSERIAL_USE_RX_BUFFERS == 1 )
+
+/* Double buffered receive.  vSerialSetRxBuffers() gives the driver two XRAM
+ * buffers of usBufferSize bytes, which the Rx ISR fills in turn.  When one is
+ * full, or the line has been idle for uxIdleBitTimes bit times (zero for no
+ * idle timeout), the ISR moves on to the other and usSerialReceiveBuffer()
+ * sets *ppucBuffer to the filled one and returns its length.  The caller must
+ * pass it back with vSerialReleaseBuffer() before the ISR can swap again;
+ * characters that arrive while both are full are counted by
+ * usSerialGetBufferOverruns().  Passing NULL buffers turns the mode off.
+ * Shares timer 1 with frame mode, so enabling either turns the other off. */
+    void vSerialSetRxBuffers( xComPortHandle pxPort,
+                              uint8_t * pucBuffer1,
+                              uint8_t * pucBuffer2,
+                              unsigned short usBufferSize,
+                              unsigned portBASE_TYPE uxIdleBitTimes );
+    unsigned short usSerialReceiveBuffer( xComPortHandle pxPort,
+                                          uint8_t ** ppucBuffer,
+                                          TickType_t xBlockTime );
+    void vSerialReleaseBuffer( xComPortHandle pxPort );
+    unsigned short usSerialGetBufferOverruns( xComPortHandle pxPort );
+#endif
+
+#if ( configUSE_ACTIVE_OBJECTS == 1 )
+
+/* Post each received character to pxAO as an event with signal ucSignal,
+ * instead of buffering it for xSerialGetChar().  Pass NULL to go back to the
+ * Rx buffer.  See active_object.h. */
+    struct xACTIVE_OBJECT;
+    void vSerialSetRxActiveObject( xComPortHandle pxPort,
+                                   struct xACTIVE_OBJECT * pxAO,
+                                   unsigned char ucSignal );
+#endif
 void vSerialClose( xComPortHandle xPort );
 
 #endif /* ifndef SERIAL_COMMS_H */
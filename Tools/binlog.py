@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Host side of the deferred binary log (Demo/Byd/binlog/binlog.c).
+
+scan    Collect every binlogPRINTn( NAME, "format", ... ) call in the given C
+        sources and write binlog_ids.h for the target and a JSON table of the
+        formats for decode.  Run by the build, see CMakeLists.txt.
+
+decode  Read the record stream from a file, a serial device set to raw mode
+        beforehand (for example "stty -F /dev/ttyUSB1 115200 raw"), or stdin,
+        and print one line of text per record.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+SYNC = 0x7E
+ID_TABLE = 0
+ID_DROPPED = 1
+FIRST_USER_ID = 2
+
+CALL = re.compile(r'\bbinlogPRINT([0-3])\s*\(\s*([A-Za-z_]\w*)\s*,\s*"((?:[^"\\\n]|\\.)*)"')
+CONVERSION = re.compile(r'%(?:%|[-+ #0]*\d*(?:\.\d+)?(hh|h|l)?([cdiuxX]))')
+ANY_CONVERSION = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|l)?.?')
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, used for the table hash."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def scan(args):
+    messages = {}
+    for path in args.sources:
+        with open(path, encoding='latin-1') as source:
+            text = source.read()
+        for match in CALL.finditer(text):
+            arity, name, fmt = int(match.group(1)), match.group(2), match.group(3)
+            line = text.count('\n', 0, match.start()) + 1
+            where = '%s:%d' % (path, line)
+            if any(not CONVERSION.fullmatch(m.group(0)) for m in ANY_CONVERSION.finditer(fmt)):
+                sys.exit('%s: %s only supports %%c, %%d, %%i, %%u, %%x and %%X' % (where, name))
+            conversions = [m for m in CONVERSION.finditer(fmt) if m.group(0) != '%%']
+            if len(conversions) != arity:
+                sys.exit('%s: %s has %d conversions for %d arguments' % (where, name, len(conversions), arity))
+            if name in messages and messages[name]['format'] != fmt:
+                sys.exit('%s: %s already used with a different format at %s' % (where, name, messages[name]['where']))
+            messages.setdefault(name, {'format': fmt, 'where': where})
+
+    # Numbered in name order, so the IDs only change when messages are added
+    # or removed.
+    table = []
+    for number, name in enumerate(sorted(messages)):
+        table.append({'id': FIRST_USER_ID + number, 'name': name, 'format': messages[name]['format']})
+
+    digest = crc16(''.join('%s\0%s\0' % (m['name'], m['format']) for m in table).encode('latin-1'))
+
+    with open(args.header, 'w') as header:
+        header.write('/* Generated by Tools/binlog.py from the sources, do not edit. */\n\n')
+        header.write('#ifndef BINLOG_IDS_H\n#define BINLOG_IDS_H\n\n')
+        header.write('#define binlogTABLE_HASH    ( 0x%04xU )\n\n' % digest)
+        for message in table:
+            header.write('#define binlogID_%s    ( %d )\n' % (message['name'], message['id']))
+        header.write('\n#endif /* BINLOG_IDS_H */\n')
+
+    with open(args.table, 'w') as out:
+        json.dump({'hash': digest, 'messages': table}, out, indent=1)
+
+
+def render(fmt, payload):
+    """Format payload with fmt, taking each argument's size from its length
+    modifier as the target's compiler sized it: 1 byte for %c and hh, 4 for l
+    and 2 (an int) otherwise."""
+    values = []
+    offset = 0
+    pieces = []
+    for match in CONVERSION.finditer(fmt):
+        if match.group(0) == '%%':
+            continue
+        modifier, kind = match.group(1), match.group(2)
+        size = 1 if (kind == 'c' or modifier == 'hh') else (4 if modifier == 'l' else 2)
+        raw = payload[offset:offset + size]
+        if len(raw) != size:
+            return None
+        offset += size
+        value = int.from_bytes(raw, 'little', signed=kind in 'di')
+        values.append(chr(value & 0xFF) if kind == 'c' else value)
+        pieces.append(match.group(0).replace('hh', '').replace('h', '').replace('l', '').replace('i', 'd').replace('u', 'd'))
+    if offset != len(payload):
+        return None
+    python_format = CONVERSION.sub(lambda m: '%%' if m.group(0) == '%%' else pieces.pop(0), fmt)
+    return python_format % tuple(values)
+
+
+def records(stream):
+    """Yield ( id, ticks, payload ) for each record with a good check byte,
+    skipping anything between records."""
+    buffer = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            return
+        buffer += chunk
+        while buffer:
+            if buffer[0] != SYNC:
+                del buffer[0]
+                continue
+            if len(buffer) < 2:
+                break
+            total = 1 + 1 + 4 + buffer[1] + 1
+            if len(buffer) < total:
+                break
+            record = buffer[1:total]
+            if sum(record) & 0xFF != 0:
+                # Not a real start, look for the next one.
+                del buffer[0]
+                continue
+            usid, ticks = struct.unpack_from('<HH', record, 1)
+            yield usid, ticks, bytes(record[5:-1])
+            del buffer[:total]
+
+
+def decode(args):
+    with open(args.table) as table_file:
+        table = json.load(table_file)
+    formats = {m['id']: m['format'] for m in table['messages']}
+    names = {m['id']: m['name'] for m in table['messages']}
+
+    stream = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb', buffering=0)
+    for usid, ticks, payload in records(stream):
+        if usid == ID_TABLE:
+            target_hash = int.from_bytes(payload, 'little')
+            if target_hash != table['hash']:
+                print('%5d  table hash 0x%04x does not match %s (0x%04x)' % (ticks, target_hash, args.table, table['hash']))
+            continue
+        if usid == ID_DROPPED:
+            print('%5d  %d records dropped' % (ticks, int.from_bytes(payload, 'little')))
+            continue
+        if usid not in formats:
+            print('%5d  unknown message %d: %s' % (ticks, usid, payload.hex()))
+            continue
+        text = render(formats[usid], payload)
+        if text is None:
+            text = '%s: arguments do not match "%s": %s' % (names[usid], formats[usid], payload.hex())
+        print('%5d  %s' % (ticks, text))
+        sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    scan_parser = commands.add_parser('scan', help='generate binlog_ids.h and the format table')
+    scan_parser.add_argument('--header', required=True)
+    scan_parser.add_argument('--table', required=True)
+    scan_parser.add_argument('sources', nargs='+')
+    scan_parser.set_defaults(run=scan)
+
+    decode_parser = commands.add_parser('decode', help='print the records in a log stream')
+    decode_parser.add_argument('--table', required=True)
+    decode_parser.add_argument('input', nargs='?', default='-')
+    decode_parser.set_defaults(run=decode)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == '__main__':
+    main()
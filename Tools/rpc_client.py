@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""Host side of the binary RPC server (Demo/Byd/rpc/rpc.c, see rpc.h).
+
+ping      Send an empty echo request and print the round trip time.
+echo      Echo the given hex bytes back.
+ticks     Print the target's tick count.
+led       Switch an LED on or off.
+status    Print the latched error flag and the target's frame error count.
+bench     Send echo requests with several in flight at once and print the
+          request rate and payload throughput.
+loopback  Check the framing on a port with Tx wired to Rx, no target needed:
+          every request comes straight back and is decoded as a response.
+
+The serial device is put into raw mode at the given baud rate, no pyserial
+needed.
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+RPC_ECHO = 0
+RPC_GET_TICKS = 1
+RPC_SET_LED = 2
+RPC_GET_STATUS = 3
+
+STATUS_OK = 0x00
+STATUS_TEXT = {0x00: 'ok', 0x01: 'unknown command', 0x02: 'bad length'}
+
+FRAME_SIZE = 64
+FRAME_OVERHEAD = 4
+MAX_PAYLOAD = FRAME_SIZE - FRAME_OVERHEAD
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as usRpcCRC16()."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block = bytearray()
+        else:
+            block.append(byte)
+            # Frames are shorter than the 254 bytes at which a full block
+            # needs a code byte of its own, but keep the encoder general.
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block = bytearray()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        if code == 0 or index + code > len(data):
+            return None
+        out += data[index + 1:index + code]
+        index += code
+        if code != 255 and index < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def make_frame(sequence, command, payload=b''):
+    body = bytes([sequence & 0xFF, command]) + bytes(payload)
+    crc = crc16(body)
+    return cobs_encode(body + bytes([crc & 0xFF, crc >> 8])) + b'\0'
+
+
+def parse_frame(encoded):
+    """Return ( sequence, status or command, payload ), or None for a frame
+    that the target would have thrown away."""
+    body = cobs_decode(encoded)
+    if body is None or len(body) < FRAME_OVERHEAD:
+        return None
+    if crc16(body[:-2]) != body[-2] | (body[-1] << 8):
+        return None
+    return body[0], body[1], body[2:-2]
+
+
+class Port:
+    def __init__(self, device, baud):
+        self.fd = os.open(device, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        attributes = termios.tcgetattr(self.fd)
+        speed = getattr(termios, 'B%d' % baud)
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.pending = bytearray()
+        # A lone zero ends whatever partial frame the target holds.
+        os.write(self.fd, b'\0')
+
+    def write(self, data):
+        view = memoryview(data)
+        while view:
+            view = view[os.write(self.fd, view):]
+
+    def read_frame(self, timeout):
+        """Return the next encoded frame, without its zero, or None on
+        timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            end = self.pending.find(0)
+            if end == 0:
+                del self.pending[0]
+                continue
+            if end > 0:
+                frame = bytes(self.pending[:end])
+                del self.pending[:end + 1]
+                return frame
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not select.select([self.fd], [], [], remaining)[0]:
+                return None
+            self.pending += os.read(self.fd, 256)
+
+
+class Client:
+    def __init__(self, port, timeout):
+        self.port = port
+        self.timeout = timeout
+        self.sequence = 0
+
+    def next_sequence(self):
+        self.sequence = (self.sequence + 1) & 0xFF
+        return self.sequence
+
+    def call(self, command, payload=b''):
+        sequence = self.next_sequence()
+        self.port.write(make_frame(sequence, command, payload))
+        while True:
+            encoded = self.port.read_frame(self.timeout)
+            if encoded is None:
+                sys.exit('no response to command %d' % command)
+            response = parse_frame(encoded)
+            if response is not None and response[0] == sequence:
+                break
+        status, data = response[1], response[2]
+        if status != STATUS_OK:
+            sys.exit('command %d failed: %s' % (command, STATUS_TEXT.get(status, 'status 0x%02x' % status)))
+        return data
+
+    def pipeline(self, requests, window):
+        """Send ( command, payload ) requests with up to window in flight and
+        return the responses in order."""
+        in_flight = {}
+        responses = []
+        queued = list(requests)
+        while queued or in_flight:
+            while queued and len(in_flight) < window:
+                command, payload = queued.pop(0)
+                sequence = self.next_sequence()
+                in_flight[sequence] = len(responses) + len(in_flight)
+                self.port.write(make_frame(sequence, command, payload))
+            encoded = self.port.read_frame(self.timeout)
+            if encoded is None:
+                sys.exit('%d responses missing' % len(in_flight))
+            response = parse_frame(encoded)
+            if response is None or response[0] not in in_flight:
+                continue
+            # The server answers in order, so anything older than this one
+            # was lost.
+            oldest = min(in_flight, key=in_flight.get)
+            if response[0] != oldest:
+                sys.exit('response %d overtook %d' % (response[0], oldest))
+            del in_flight[response[0]]
+            responses.append(response)
+        return responses
+
+
+def run_ping(client, args):
+    start = time.monotonic()
+    client.call(RPC_ECHO)
+    print('%.1f ms' % ((time.monotonic() - start) * 1000))
+
+
+def run_echo(client, args):
+    payload = bytes.fromhex(args.data)
+    if len(payload) > MAX_PAYLOAD:
+        sys.exit('at most %d bytes' % MAX_PAYLOAD)
+    reply = client.call(RPC_ECHO, payload)
+    print(reply.hex())
+    if reply != payload:
+        sys.exit('echo mismatch')
+
+
+def run_ticks(client, args):
+    print(int.from_bytes(client.call(RPC_GET_TICKS), 'little'))
+
+
+def run_led(client, args):
+    client.call(RPC_SET_LED, bytes([args.led, 1 if args.state == 'on' else 0]))
+
+
+def run_status(client, args):
+    reply = client.call(RPC_GET_STATUS)
+    print('latched error %d, frame errors %d' % (reply[0], int.from_bytes(reply[1:3], 'little')))
+
+
+def run_bench(client, args):
+    size = min(args.size, MAX_PAYLOAD)
+    requests = [(RPC_ECHO, bytes((n + i) & 0xFF or 1 for i in range(size))) for n in range(args.count)]
+    start = time.monotonic()
+    responses = client.pipeline(requests, args.window)
+    elapsed = time.monotonic() - start
+    for (command, payload), response in zip(requests, responses):
+        if response[1] != STATUS_OK or response[2] != payload:
+            sys.exit('bad echo in sequence %d' % response[0])
+    print('%d requests of %d bytes, %d in flight: %.0f requests/s, %.0f payload bytes/s each way'
+          % (args.count, size, args.window, args.count / elapsed, args.count * size / elapsed))
+
+
+def run_loopback(client, args):
+    # A request comes back as itself, so its command byte stands in for the
+    # status and must be 0 for call() to accept it, and its payload is the
+    # echo.
+    for size in (0, 1, 2, MAX_PAYLOAD):
+        for payload in (bytes(size), bytes(range(1, size + 1)), bytes((i * 37) & 0xFF for i in range(size))):
+            if client.call(RPC_ECHO, payload) != payload:
+                sys.exit('loopback mismatch, %d bytes' % size)
+    responses = client.pipeline([(RPC_ECHO, bytes([n])) for n in range(args.count)], args.window)
+    print('loopback ok, %d pipelined frames' % len(responses))
+
+
+def self_test():
+    """Check COBS and the CRC without a port."""
+    assert crc16(b'123456789') == 0x29B1
+    for data in (b'', b'\0', b'\0\0', b'\x11\0\x22', bytes(range(256)), bytes(range(1, 255)) * 2):
+        encoded = cobs_encode(data)
+        assert 0 not in encoded, data
+        assert cobs_decode(encoded) == data, data
+    assert cobs_encode(b'\x11\0\x22') == b'\x02\x11\x02\x22'
+    frame = make_frame(5, RPC_ECHO, b'\0ab')
+    assert parse_frame(frame[:-1]) == (5, RPC_ECHO, b'\0ab')
+    assert parse_frame(frame[:-2] + bytes([frame[-2] ^ 1])) is None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', default='/dev/ttyUSB0')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--timeout', type=float, default=1.0)
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    commands.add_parser('ping').set_defaults(run=run_ping)
+    echo = commands.add_parser('echo')
+    echo.add_argument('data', help='hex bytes')
+    echo.set_defaults(run=run_echo)
+    commands.add_parser('ticks').set_defaults(run=run_ticks)
+    led = commands.add_parser('led')
+    led.add_argument('led', type=int)
+    led.add_argument('state', choices=('on', 'off'))
+    led.set_defaults(run=run_led)
+    commands.add_parser('status').set_defaults(run=run_status)
+    for name, run in (('bench', run_bench), ('loopback', run_loopback)):
+        sub = commands.add_parser(name)
+        sub.add_argument('--count', type=int, default=200)
+        # Every request in flight must fit the server's frame buffer and the
+        # driver's Rx ring, two 16 byte echoes do with the default sizes.
+        sub.add_argument('--window', type=int, default=2)
+        sub.add_argument('--size', type=int, default=16)
+        sub.set_defaults(run=run)
+    commands.add_parser('selftest', help='check COBS and the CRC, no port needed').set_defaults(run=None)
+
+    args = parser.parse_args()
+    self_test()
+    if args.run is None:
+        print('ok')
+        return
+    args.run(Client(Port(args.port, args.baud), args.timeout), args)
+
+
+if __name__ == '__main__':
+    main()